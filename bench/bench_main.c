@@ -0,0 +1,182 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : bench_main.c
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Cycle benchmark firmware for ucsim_51 (make bench).
+ *                Feeds fixed DGUS frames and VP changes to the real library
+ *                code and times each case with Timer0 (one count per 8051
+ *                machine cycle in ucsim). Results land in bench_cycles[],
+ *                which the ucsim script dumps when bench_done() is reached.
+ *
+ *                The case list below is also read by tools/bench_cmp.awk:
+ *                one "BENCH_xxx, // name" line per case, in result order.
+ * ----------------------------------------------------------------------------- */
+#include "t5l1.h"
+#include "config.h"
+#include "uart.h"
+#include "sys.h"
+#include "crc16.h"
+#include "event.h"
+#include "pool.h"
+
+enum
+{
+    BENCH_OVERHEAD,   // timer_overhead
+    BENCH_CRC16,      // crc16table_256B
+    BENCH_PARSE_82,   // parse_82_8w
+    BENCH_PARSE_83,   // parse_83_8w
+    BENCH_CMD82,      // cmd82_8w
+    BENCH_CMD83,      // cmd83_8w
+    BENCH_MON_IDLE,   // monitor_idle
+    BENCH_MON_4W,     // monitor_4w
+    BENCH_COUNT
+};
+
+#define BENCH_VP 0x2000  // scratch VP block, outside the watch list
+#define BENCH_OVF 0xFFFF // case ran past one Timer0 period
+
+__xdata u16 bench_cycles[BENCH_COUNT]; // dumped by the ucsim script
+
+static __xdata u8 crc_buf[256];
+static __xdata u8 frame82[32];
+static __xdata u8 frame83[16];
+static __xdata u8 resp83[64];
+static __xdata u16 frame82_len;
+static __xdata u16 frame83_len;
+
+/* ---- Timer0: mode 1, no interrupt, one count per machine cycle ---- */
+static void bench_start(void)
+{
+    TR0 = 0;
+    TF0 = 0;
+    TH0 = 0;
+    TL0 = 0;
+    TR0 = 1;
+}
+
+static void bench_stop(u8 id)
+{
+    u16 t;
+
+    TR0 = 0;
+    t = ((u16)TH0 << 8) | TL0;
+    if (TF0)
+        t = BENCH_OVF;
+    else if (id != BENCH_OVERHEAD)
+        t = (t > bench_cycles[BENCH_OVERHEAD]) ? (u16)(t - bench_cycles[BENCH_OVERHEAD]) : 0;
+    bench_cycles[id] = t;
+}
+
+/* Finish a frame: LEN covers cmd..data (+ CRC when USE_CRC), returns total bytes */
+static u16 bench_frame(u8 *f, u8 payload)
+{
+#if USE_CRC
+    u16 crc = crc16table(f + 3, payload);
+    f[3 + payload] = (u8)crc;
+    f[4 + payload] = (u8)(crc >> 8);
+    payload += 2;
+#endif
+    f[0] = 0x5A;
+    f[1] = 0xA5;
+    f[2] = payload;
+    return (u16)payload + 3u;
+}
+
+static void bench_stimulus(void)
+{
+    u16 i;
+
+    for (i = 0; i < sizeof(crc_buf); i++)
+        crc_buf[i] = (u8)i;
+
+    /* 0x82: write 8 words to BENCH_VP */
+    frame82[3] = 0x82;
+    frame82[4] = (u8)(BENCH_VP >> 8);
+    frame82[5] = (u8)BENCH_VP;
+    for (i = 0; i < 16; i++)
+        frame82[6 + i] = (u8)(0x11 * ((i >> 1) + 1));
+    frame82_len = bench_frame(frame82, 3 + 16);
+
+    /* 0x83: read the same 8 words back */
+    frame83[3] = 0x83;
+    frame83[4] = (u8)(BENCH_VP >> 8);
+    frame83[5] = (u8)BENCH_VP;
+    frame83[6] = 8;
+    frame83_len = bench_frame(frame83, 4);
+}
+
+/* Panel side of the monitor: 0x0F00 = 5A:AddrH, 0x0F01 = AddrL:words */
+static void bench_panel_change(u16 vp, u8 words)
+{
+    DGUS_Write_VP(0x0F00, 0x5A00 | (vp >> 8));
+    DGUS_Write_VP(0x0F01, ((vp & 0xFF) << 8) | words);
+}
+
+static void bench_drain(void)
+{
+    evt_t ev;
+
+    while (Event_Pop(&ev))
+        ;
+}
+
+/* ucsim breaks here; keep it a real call so the symbol has its own address */
+void bench_done(void)
+{
+    for (;;)
+        ;
+}
+
+void main(void)
+{
+    u16 len;
+
+    EA = 0; // no interrupt may land inside a timed case
+    TMOD = (TMOD & 0xF0) | 0x01;
+    Pool_Init(); // 0x83 answers and the monitor packet come from the pool
+    bench_stimulus();
+
+    bench_start();
+    bench_stop(BENCH_OVERHEAD);
+
+    bench_start();
+    crc16table(crc_buf, sizeof(crc_buf));
+    bench_stop(BENCH_CRC16);
+
+    len = frame82_len;
+    bench_start();
+    DGUS_ParseUartFrame(frame82, &len, 2, RESPONSE_UART2, USE_CRC);
+    bench_stop(BENCH_PARSE_82);
+    bench_drain();
+
+    len = frame83_len;
+    bench_start();
+    DGUS_ParseUartFrame(frame83, &len, 2, RESPONSE_UART2, USE_CRC);
+    bench_stop(BENCH_PARSE_83);
+    bench_drain();
+
+    Response_flog = RESPONSE_UART2;
+    Crc_check_flog = USE_CRC;
+    bench_start();
+    DGUS_HandleCmd82(2, frame82);
+    bench_stop(BENCH_CMD82);
+
+    bench_start();
+    DGUS_HandleCmd83(2, resp83, frame83);
+    bench_stop(BENCH_CMD83);
+
+    DGUS_Write_VP(0x0F00, 0);
+    bench_start();
+    DGUS_MonitorAndSendUpdates();
+    bench_stop(BENCH_MON_IDLE);
+
+    bench_panel_change(0x2100, 4); // four watched VPs changed
+    bench_start();
+    DGUS_MonitorAndSendUpdates();
+    bench_stop(BENCH_MON_4W);
+    bench_drain();
+
+    bench_done();
+}
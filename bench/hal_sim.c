@@ -0,0 +1,68 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : hal_sim.c
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : 8051-side HAL for the ucsim benchmark build (T5L_SIM).
+ *                ucsim has no DGUS core, so DGUS RAM is a small XRAM window
+ *                (VP address masked to SIM_VPS words) served with the same
+ *                RAMMODE / ADR_INC rules as the T5L. Waits on the 1 ms tick
+ *                advance the tick at once, so delays cost no cycles.
+ * ----------------------------------------------------------------------------- */
+#include "t5l1.h"
+#include "hal.h"
+#include "timer.h"
+
+#define SIM_VPS 1024u // VP window, power of two
+
+static __xdata u16 sim_vp[SIM_VPS];
+
+/**
+ * @brief Run the DGUS access set up in RAMMODE/ADR/DATA on the XRAM window.
+ */
+void Hal_SimDgusKick(void)
+{
+    u16 cell = ((u16)ADR_M << 8) | ADR_L; // ADR_H is beyond the window
+    u16 vp = (cell << 1) & (SIM_VPS - 1);
+    u8 mode = RAMMODE;
+
+    if (mode & 0x20)
+    {
+        DATA3 = (u8)(sim_vp[vp] >> 8);
+        DATA2 = (u8)sim_vp[vp];
+        DATA1 = (u8)(sim_vp[vp + 1] >> 8);
+        DATA0 = (u8)sim_vp[vp + 1];
+    }
+    else
+    {
+        if (mode & 0x08)
+            sim_vp[vp] = (sim_vp[vp] & 0x00FF) | ((u16)DATA3 << 8);
+        if (mode & 0x04)
+            sim_vp[vp] = (sim_vp[vp] & 0xFF00) | DATA2;
+        vp++;
+        if (mode & 0x02)
+            sim_vp[vp] = (sim_vp[vp] & 0x00FF) | ((u16)DATA1 << 8);
+        if (mode & 0x01)
+            sim_vp[vp] = (sim_vp[vp] & 0xFF00) | DATA0;
+    }
+
+    if (ADR_INC)
+    {
+        cell += ADR_INC;
+        ADR_M = (u8)(cell >> 8);
+        ADR_L = (u8)cell;
+    }
+    APP_EN = 0;
+    APP_ACK = 1;
+}
+
+/**
+ * @brief Stand-in for one Timer2 tick (Timer2 is not simulated for the T5L).
+ */
+void Hal_SimTick(void)
+{
+    sys_tick_ms++;
+    sys_uptime_ms++;
+    sys_uptime_us += 1000;
+}
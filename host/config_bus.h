@@ -0,0 +1,17 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : config_bus.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Host bus configuration (make host, build/host/t5l_host_bus),
+ *                included at the end of config.h. It turns on the port
+ *                settings the default configuration leaves off, so that
+ *                host_main.c can check them: UART4 is RS485 node 7, UART5
+ *                is a Modbus RTU master polling host/mb_poll_bus.txt.
+ * ----------------------------------------------------------------------------- */
+#undef UART4_NODE
+#define UART4_NODE 7
+
+#undef UART5_PROTO
+#define UART5_PROTO 2
@@ -0,0 +1,197 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : hal_host.c / hal_host.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Host (gcc) side of the hardware abstraction layer.
+ *                Included by t5l1.h when T5L_HOST is defined (make host):
+ *                sized integer types, SDCC keywords compiled away, and every
+ *                SFR / sbit backed by a simulated register file, with a DGUS
+ *                RAM model, virtual UART2..5 and a virtual Timer2 clock.
+ * ----------------------------------------------------------------------------- */
+#include <string.h>
+#include "uart.h"
+#include "timer.h"
+
+volatile hal_sfr_t hal_sfr[256];
+u16 hal_dgus_ram[HAL_DGUS_VPS];
+u8 hal_uart_out[6][HAL_UART_OUT_LEN];
+u16 hal_uart_out_len[6];
+u32 hal_ms = 0;
+
+/* TX ISRs without a prototype in uart.h */
+void uart4_TISR(void);
+void uart5_TISR(void);
+
+#define HAL_T1_PER_MS 200 // Timer1 interrupts per ms when running (I2C half bit, 5 us)
+
+/**
+ * @brief Reset the register file, DGUS RAM, UART capture and virtual time.
+ */
+void Hal_Init(void)
+{
+    memset((void *)hal_sfr, 0, sizeof(hal_sfr));
+    memset(hal_dgus_ram, 0, sizeof(hal_dgus_ram));
+    memset(hal_uart_out_len, 0, sizeof(hal_uart_out_len));
+    hal_ms = 0;
+}
+
+/**
+ * @brief Advance virtual time by 1 ms: run Timer1_ISR while Timer1 is on
+ *        (I2C engine), then one Timer2_ISR (system tick, UART timeouts).
+ *        Called by the firmware's tick waits through HAL_WAIT_TICK().
+ */
+void Hal_Step(void)
+{
+    u16 i;
+
+    for (i = 0; i < HAL_T1_PER_MS && TR1; i++)
+        Timer1_ISR();
+
+    hal_ms++;
+    if (TR2)
+    {
+        TF2 = 1;
+        Timer2_ISR();
+    }
+    TH2 = TRL2H; // count restarts from the reload value
+    TL2 = TRL2L;
+}
+
+/**
+ * @brief Advance virtual time by 'ms' milliseconds.
+ */
+void Hal_Run(u32 ms)
+{
+    while (ms--)
+        Hal_Step();
+}
+
+/**
+ * @brief One DGUS RAM access as set up in ADR_H/M/L, RAMMODE and DATA3..0.
+ *
+ * The address selects a 32-bit cell (two VPs): DATA3:DATA2 is the even VP,
+ * DATA1:DATA0 the odd one. APP_RW (RAMMODE bit 5) = 1 reads both words,
+ * otherwise RAMMODE bits 3..0 select the DATA3..DATA0 lanes written. The
+ * address then moves on by ADR_INC cells.
+ */
+void Hal_DgusKick(void)
+{
+    u32 cell = ((u32)ADR_H << 16) | ((u32)ADR_M << 8) | ADR_L;
+    u16 vp = (u16)(cell << 1);
+    u8 mode = RAMMODE;
+
+    if (mode & 0x20)
+    {
+        DATA3 = (u8)(hal_dgus_ram[vp] >> 8);
+        DATA2 = (u8)hal_dgus_ram[vp];
+        DATA1 = (u8)(hal_dgus_ram[(u16)(vp + 1)] >> 8);
+        DATA0 = (u8)hal_dgus_ram[(u16)(vp + 1)];
+    }
+    else
+    {
+        if (mode & 0x08)
+            hal_dgus_ram[vp] = (hal_dgus_ram[vp] & 0x00FF) | ((u16)DATA3 << 8);
+        if (mode & 0x04)
+            hal_dgus_ram[vp] = (hal_dgus_ram[vp] & 0xFF00) | DATA2;
+        vp++;
+        if (mode & 0x02)
+            hal_dgus_ram[vp] = (hal_dgus_ram[vp] & 0x00FF) | ((u16)DATA1 << 8);
+        if (mode & 0x01)
+            hal_dgus_ram[vp] = (hal_dgus_ram[vp] & 0xFF00) | DATA0;
+    }
+
+    if (ADR_INC)
+    {
+        cell += ADR_INC;
+        ADR_H = (u8)(cell >> 16);
+        ADR_M = (u8)(cell >> 8);
+        ADR_L = (u8)cell;
+    }
+    APP_EN = 0;
+    APP_ACK = 1;
+}
+
+/* Record one transmitted byte */
+static void hal_uart_capture(u8 uart, u8 b)
+{
+    if (hal_uart_out_len[uart] < HAL_UART_OUT_LEN)
+        hal_uart_out[uart][hal_uart_out_len[uart]++] = b;
+}
+
+/**
+ * @brief Complete a byte written to SBUFx: capture it and raise the
+ *        transmit interrupt at once (no line time on the host).
+ */
+void Hal_UartTx(u8 uart)
+{
+    switch (uart)
+    {
+    case 2:
+        hal_uart_capture(2, SBUF2);
+        TI2 = 1;
+        uart2_ISR();
+        break;
+    case 3:
+        hal_uart_capture(3, SBUF3);
+        SCON3 |= 0x02;
+        uart3_ISR();
+        break;
+    case 4:
+        hal_uart_capture(4, SBUF4_TX);
+        TI4 = 1;
+        uart4_TISR();
+        break;
+    case 5:
+        hal_uart_capture(5, SBUF5_TX);
+        TI5 = 1;
+        uart5_TISR();
+        break;
+    }
+}
+
+/**
+ * @brief Feed received bytes to a UART through its RX ISR. The frame is
+ *        complete for DGUS_ProcessAllUarts() once the inter-byte timeout
+ *        has run down (Hal_Run(5) or more).
+ */
+void Hal_UartRx(u8 uart, const u8 *buf, u16 len)
+{
+    while (len--)
+    {
+        u8 b = *buf++;
+
+        switch (uart)
+        {
+        case 2:
+            SBUF2 = b;
+            RI2 = 1;
+            uart2_ISR();
+            break;
+        case 3:
+            SBUF3 = b;
+            SCON3 |= 0x01;
+            uart3_ISR();
+            break;
+        case 4:
+            SBUF4_RX = b;
+            RI4 = 1;
+            uart4_RISR();
+            break;
+        case 5:
+            SBUF5_RX = b;
+            RI5 = 1;
+            uart5_RISR();
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Drop the bytes captured on a UART.
+ */
+void Hal_UartClear(u8 uart)
+{
+    hal_uart_out_len[uart] = 0;
+}
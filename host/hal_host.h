@@ -0,0 +1,179 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : hal_host.c / hal_host.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Host (gcc) side of the hardware abstraction layer.
+ *                Included by t5l1.h when T5L_HOST is defined (make host):
+ *                sized integer types, SDCC keywords compiled away, and every
+ *                SFR / sbit backed by a simulated register file, with a DGUS
+ *                RAM model, virtual UART2..5 and a virtual Timer2 clock.
+ * ----------------------------------------------------------------------------- */
+#ifndef __HAL_HOST_H__
+#define __HAL_HOST_H__
+
+/* 8051 widths (gcc: int is 32-bit, long is 64-bit on Linux) */
+#define u8 unsigned char
+#define s8 signed char
+#define u16 unsigned short
+#define s16 signed short
+#define u32 unsigned int
+#define s32 signed int
+
+/* SDCC storage classes and function attributes */
+#define __xdata
+#define __idata
+#define __data
+#define __pdata
+#define __code
+#define __bit unsigned char
+#define __interrupt(x)
+#define __using(x)
+#define __reentrant
+#define __critical
+
+/* Simulated SFR space: one byte per address, bit-addressable through b0..b7 */
+typedef union
+{
+    unsigned char v;
+    struct
+    {
+        unsigned char b0 : 1, b1 : 1, b2 : 1, b3 : 1, b4 : 1, b5 : 1, b6 : 1, b7 : 1;
+    };
+} hal_sfr_t;
+
+extern volatile hal_sfr_t hal_sfr[256];
+
+#define HAL_SFR(a) (hal_sfr[a].v)
+#define HAL_SBIT(a, n) (hal_sfr[a].b##n)
+
+/* Same names as the SDCC declarations in t5l1.h */
+#define P0           HAL_SFR(0x80)
+#define P1           HAL_SFR(0x90)
+#define RI0          HAL_SBIT(0x98, 0)
+#define TI0          HAL_SBIT(0x98, 1)
+#define PCON         HAL_SFR(0x87)
+#define TMOD         HAL_SFR(0x89)
+#define TCON         HAL_SFR(0x88)
+#define CKCON        HAL_SFR(0x8E)
+#define DPC          HAL_SFR(0x93)
+#define PAGESEL      HAL_SFR(0x94)
+#define D_PAGESEL    HAL_SFR(0x95)
+#define MUX_SEL      HAL_SFR(0xC9)
+#define RAMMODE      HAL_SFR(0xF8)
+#define APP_REQ      HAL_SBIT(0xF8, 7)
+#define APP_EN       HAL_SBIT(0xF8, 6)
+#define APP_RW       HAL_SBIT(0xF8, 5)
+#define APP_ACK      HAL_SBIT(0xF8, 4)
+#define ADR_H        HAL_SFR(0xF1)
+#define ADR_M        HAL_SFR(0xF2)
+#define ADR_L        HAL_SFR(0xF3)
+#define ADR_INC      HAL_SFR(0xF4)
+#define DATA3        HAL_SFR(0xFA)
+#define DATA2        HAL_SFR(0xFB)
+#define DATA1        HAL_SFR(0xFC)
+#define DATA0        HAL_SFR(0xFD)
+#define PORTDRV      HAL_SFR(0xF9)
+#define TH1          HAL_SFR(0x8D)
+#define TL1          HAL_SFR(0x8B)
+#define IEN0         HAL_SFR(0xA8)
+#define EA           HAL_SBIT(0xA8, 7)
+#define ET2          HAL_SBIT(0xA8, 5)
+#define ES0          HAL_SBIT(0xA8, 4)
+#define ET1          HAL_SBIT(0xA8, 3)
+#define EX1          HAL_SBIT(0xA8, 2)
+#define ET0          HAL_SBIT(0xA8, 1)
+#define EX0          HAL_SBIT(0xA8, 0)
+#define IEN1         HAL_SFR(0xB8)
+#define ES5R         HAL_SBIT(0xB8, 5)
+#define ES5T         HAL_SBIT(0xB8, 4)
+#define ES4R         HAL_SBIT(0xB8, 3)
+#define ES4T         HAL_SBIT(0xB8, 2)
+#define ECAN         HAL_SBIT(0xB8, 1)
+#define IEN2         HAL_SFR(0x9A)
+#define IP0          HAL_SFR(0xA9)
+#define IP1          HAL_SFR(0xB9)
+#define P0MDOUT      HAL_SFR(0xB7)
+#define P1MDOUT      HAL_SFR(0xBC)
+#define P2MDOUT      HAL_SFR(0xBD)
+#define P3MDOUT      HAL_SFR(0xBE)
+#define RTC_DIR_REG  P3MDOUT
+#define IRCON2       HAL_SFR(0xBF)
+#define IRCON        HAL_SFR(0xC0)
+#define TF2          HAL_SBIT(0xC0, 6)
+#define T2CON        HAL_SFR(0xC8)
+#define TR2          HAL_SBIT(0xC8, 0)
+#define TRL2H        HAL_SFR(0xCB)
+#define TRL2L        HAL_SFR(0xCA)
+#define TH2          HAL_SFR(0xCD)
+#define TL2          HAL_SFR(0xCC)
+#define P2           HAL_SFR(0xA0)
+#define P3           HAL_SFR(0xB0)
+#define RTC_SDA      HAL_SBIT(0xB0, 3)
+#define RTC_SCL      HAL_SBIT(0xB0, 2)
+#define TH0          HAL_SFR(0x8C)
+#define TL0          HAL_SFR(0x8A)
+#define TF1          HAL_SBIT(0x88, 7)
+#define TR1          HAL_SBIT(0x88, 6)
+#define TF0          HAL_SBIT(0x88, 5)
+#define TR0          HAL_SBIT(0x88, 4)
+#define IE1          HAL_SBIT(0x88, 3)
+#define IT1          HAL_SBIT(0x88, 2)
+#define IE0          HAL_SBIT(0x88, 1)
+#define IT0          HAL_SBIT(0x88, 0)
+#define SCON2        HAL_SFR(0x98)
+#define TI2          HAL_SBIT(0x98, 1)
+#define RI2          HAL_SBIT(0x98, 0)
+#define SBUF2        HAL_SFR(0x99)
+#define SREL2H       HAL_SFR(0xBA)
+#define SREL2L       HAL_SFR(0xAA)
+#define ADCON        HAL_SFR(0xD8)
+#define SCON3        HAL_SFR(0x9B)
+#define TI3          HAL_SBIT(0x9B, 1)
+#define RI3          HAL_SBIT(0x9B, 0)
+#define SBUF3        HAL_SFR(0x9C)
+#define SREL3H       HAL_SFR(0xBB)
+#define SREL3L       HAL_SFR(0x9D)
+#define SCON4T       HAL_SFR(0x96)
+#define TI4          HAL_SBIT(0x96, 0)
+#define SCON4R       HAL_SFR(0x97)
+#define RI4          HAL_SBIT(0x97, 0)
+#define BODE4_DIV_H  HAL_SFR(0xD9)
+#define BODE4_DIV_L  HAL_SFR(0xE7)
+#define SBUF4_TX     HAL_SFR(0x9E)
+#define SBUF4_RX     HAL_SFR(0x9F)
+#define TR4          HAL_SBIT(0x80, 0)
+#define SCON5T       HAL_SFR(0xA7)
+#define TI5          HAL_SBIT(0xA7, 0)
+#define SCON5R       HAL_SFR(0xAB)
+#define RI5          HAL_SBIT(0xAB, 0)
+#define BODE5_DIV_H  HAL_SFR(0xAE)
+#define BODE5_DIV_L  HAL_SFR(0xAF)
+#define SBUF5_TX     HAL_SFR(0xAC)
+#define SBUF5_RX     HAL_SFR(0xAD)
+#define TR5          HAL_SBIT(0x80, 1)
+#define CAN_CR       HAL_SFR(0x8F)
+#define CAN_IR       HAL_SFR(0x91)
+#define CAN_ET       HAL_SFR(0xE8)
+
+/* DGUS RAM model: one 16-bit word per VP */
+#define HAL_DGUS_VPS 0x10000UL
+extern u16 hal_dgus_ram[HAL_DGUS_VPS];
+
+/* Virtual UART2..5: bytes the firmware sent, per port */
+#define HAL_UART_OUT_LEN 1024
+extern u8 hal_uart_out[6][HAL_UART_OUT_LEN];
+extern u16 hal_uart_out_len[6];
+
+extern u32 hal_ms; // virtual time, advanced by Hal_Step()
+
+void Hal_Init(void);
+void Hal_Step(void);
+void Hal_Run(u32 ms);
+void Hal_DgusKick(void);
+void Hal_UartTx(u8 uart);
+void Hal_UartRx(u8 uart, const u8 *buf, u16 len);
+void Hal_UartClear(u8 uart);
+
+#endif
@@ -0,0 +1,510 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : host_main.c
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Host runner for the libraries (make host).
+ *                Boots the firmware init on the simulated HAL, pushes DGUS
+ *                0x82 / 0x83 frames through a virtual UART2 and times the
+ *                protocol and DGUS-access paths with the host clock.
+ *                Modbus RTU slave requests are checked on UART3. The bus
+ *                configuration (t5l_host_bus, host/config_bus.h) also runs
+ *                RS485 node addressing on UART4 and the Modbus master on
+ *                UART5.
+ *
+ *  Usage : build/host/t5l_host [iterations]
+ * ----------------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "uart.h"
+#include "sys.h"
+#include "crc16.h"
+#include "timer.h"
+#include "event.h"
+#include "vpinit.h"
+#include "pool.h"
+#include "modbus.h"
+
+#define BENCH_VP 0x2000 // scratch VP block, outside the watch list
+
+static u32 iterations = 100000;
+
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void report(const char *name, double ns, u32 n)
+{
+    printf("  %-28s %10.1f ns/op  (%u ops)\n", name, ns / n, n);
+}
+
+/* Deliver a frame on UART2, let the inter-byte timeout expire, then time the parse */
+static double uart2_frame(const u8 *frame, u16 len)
+{
+    double t0;
+
+    Hal_UartRx(2, frame, len);
+    Hal_Run(6);
+    t0 = now_ns();
+    DGUS_ProcessAllUarts();
+    return now_ns() - t0;
+}
+
+static void bench_crc(void)
+{
+    static u8 buf[256];
+    volatile u16 crc = 0;
+    double t0;
+    u32 i;
+
+    for (i = 0; i < sizeof(buf); i++)
+        buf[i] = (u8)i;
+    t0 = now_ns();
+    for (i = 0; i < iterations; i++)
+        crc ^= crc16table(buf, sizeof(buf));
+    report("crc16table (256 B)", now_ns() - t0, iterations);
+}
+
+static void bench_vp(void)
+{
+    volatile u16 v = 0;
+    double t0;
+    u32 i;
+
+    t0 = now_ns();
+    for (i = 0; i < iterations; i++)
+        DGUS_Write_VP(BENCH_VP + (i & 0xFF), (u16)i);
+    report("DGUS_Write_VP", now_ns() - t0, iterations);
+
+    t0 = now_ns();
+    for (i = 0; i < iterations; i++)
+        v ^= DGUS_Read_VP(BENCH_VP + (i & 0xFF));
+    report("DGUS_Read_VP", now_ns() - t0, iterations);
+}
+
+/* Boot table: every run lands in DGUS RAM */
+static int bench_vp_init(void)
+{
+    double t0;
+    u32 n = iterations / 100 + 1, i;
+    u16 r, k;
+
+    t0 = now_ns();
+    for (i = 0; i < n; i++)
+        VP_Init_Apply();
+    report("VP_Init_Apply", now_ns() - t0, n);
+
+#if VP_INIT_RUNS
+    for (r = 0; r < VP_INIT_RUNS; r++)
+        for (k = 0; k < VP_Init_Len[r]; k++)
+            if (hal_dgus_ram[VP_Init_First[r] + k] != VP_Init_Data[VP_Init_Off[r] + k])
+                return 0;
+#endif
+    return 1;
+}
+
+static int bench_frames(void)
+{
+    /* 5A A5 len 82 addr data..., 8 words */
+    static const u8 f82[] = {0x5A, 0xA5, 0x13, 0x82, 0x20, 0x00,
+                             0x11, 0x11, 0x22, 0x22, 0x33, 0x33, 0x44, 0x44,
+                             0x55, 0x55, 0x66, 0x66, 0x77, 0x77, 0x88, 0x88};
+    /* 5A A5 len 83 addr words */
+    static const u8 f83[] = {0x5A, 0xA5, 0x04, 0x83, 0x20, 0x00, 0x08};
+    /* more words than an answer block holds: ignored */
+    static const u8 f83big[] = {0x5A, 0xA5, 0x04, 0x83, 0x20, 0x00, 0xFF};
+    double t82 = 0, t83 = 0;
+    u32 n = iterations / 100 + 1, i;
+    int ok = 1;
+
+    for (i = 0; i < n; i++)
+    {
+        Hal_UartClear(2);
+        t82 += uart2_frame(f82, sizeof(f82));
+        Hal_UartClear(2);
+        t83 += uart2_frame(f83, sizeof(f83));
+    }
+    report("0x82 frame, 8 words", t82, n);
+    report("0x83 frame, 8 words", t83, n);
+
+    /* Check: only the armed RX blocks are still taken from the pool */
+    if (pool_used != UART2_ENABLE + UART3_ENABLE + UART4_ENABLE + UART5_ENABLE)
+        ok = 0;
+
+    /* Check: VPs written, 0x83 answer carries them back */
+    if (hal_dgus_ram[BENCH_VP] != 0x1111 || hal_dgus_ram[BENCH_VP + 7] != 0x8888)
+        ok = 0;
+    if (hal_uart_out_len[2] < 7 + 16 || hal_uart_out[2][3] != 0x83 ||
+        hal_uart_out[2][7] != 0x11 || hal_uart_out[2][7 + 15] != 0x88)
+        ok = 0;
+
+    Hal_UartClear(2);
+    uart2_frame(f83big, sizeof(f83big));
+    if (hal_uart_out_len[2] != 0)
+        ok = 0;
+
+    /* Check: a read whose answer finds no pool block is counted as a drop */
+    {
+        __xdata u8 *held[POOL_QUOTA_UART];
+        u16 drops = dgus_reply_drops;
+        u8 k = 0, j;
+
+        while (k < POOL_QUOTA_UART && (held[k] = Pool_Alloc(POOL_OWNER_UART(2))) != 0)
+            k++;
+        if (k)
+            Pool_Free(held[--k]); // one left for the frame, none for the answer
+        Hal_UartClear(2);
+        uart2_frame(f83, sizeof(f83));
+        if (hal_uart_out_len[2] != 0 || dgus_reply_drops != drops + 1)
+            ok = 0;
+        for (j = 0; j < k; j++)
+            Pool_Free(held[j]);
+    }
+    return ok;
+}
+
+/* Append the Modbus CRC to a request buffer */
+static void mb_crc(u8 *f, u16 len)
+{
+    u16 crc = crc16table(f, len - 2);
+
+    f[len - 2] = (u8)crc;
+    f[len - 1] = (u8)(crc >> 8);
+}
+
+/* Modbus slave on UART3: FC16 write, FC03 read back, exception outside the window */
+static int bench_modbus(void)
+{
+    static u8 f16[] = {MODBUS_SLAVE_ID, 0x10, 0x00, 0x10, 0x00, 0x02, 0x04, 0x12, 0x34, 0x56, 0x78, 0, 0};
+    /* odd start register: single VP, one cell burst, single VP */
+    static u8 f16odd[] = {MODBUS_SLAVE_ID, 0x10, 0x00, 0x21, 0x00, 0x04, 0x08,
+                          0xA1, 0xA2, 0xB1, 0xB2, 0xC1, 0xC2, 0xD1, 0xD2, 0, 0};
+    static u8 f03[] = {MODBUS_SLAVE_ID, 0x03, 0x00, 0x10, 0x00, 0x02, 0, 0};
+    static u8 fbad[] = {MODBUS_SLAVE_ID, 0x03, 0xFF, 0xFF, 0x00, 0x02, 0, 0};
+    int ok = 1;
+
+    mb_crc(f16, sizeof(f16));
+    mb_crc(f03, sizeof(f03));
+    mb_crc(f16odd, sizeof(f16odd));
+    mb_crc(fbad, sizeof(fbad));
+
+    Hal_UartClear(3);
+    Modbus_SlaveFrame(3, f16, sizeof(f16));
+    if (hal_dgus_ram[MODBUS_VP_BASE + 0x10] != 0x1234 || hal_dgus_ram[MODBUS_VP_BASE + 0x11] != 0x5678 ||
+        hal_uart_out_len[3] != 8 || hal_uart_out[3][1] != 0x10 || hal_uart_out[3][5] != 0x02)
+        ok = 0;
+
+    Hal_UartClear(3);
+    Modbus_SlaveFrame(3, f03, sizeof(f03));
+    if (hal_uart_out_len[3] != 9 || hal_uart_out[3][2] != 4 || hal_uart_out[3][3] != 0x12 ||
+        hal_uart_out[3][6] != 0x78 || crc16table(hal_uart_out[3], 7) != (hal_uart_out[3][8] << 8 | hal_uart_out[3][7]))
+        ok = 0;
+
+    Hal_UartClear(3);
+    Modbus_SlaveFrame(3, f16odd, sizeof(f16odd));
+    if (hal_dgus_ram[MODBUS_VP_BASE + 0x21] != 0xA1A2 || hal_dgus_ram[MODBUS_VP_BASE + 0x22] != 0xB1B2 ||
+        hal_dgus_ram[MODBUS_VP_BASE + 0x23] != 0xC1C2 || hal_dgus_ram[MODBUS_VP_BASE + 0x24] != 0xD1D2 ||
+        hal_dgus_ram[MODBUS_VP_BASE + 0x20] != 0 || hal_dgus_ram[MODBUS_VP_BASE + 0x25] != 0 || hal_uart_out_len[3] != 8)
+        ok = 0;
+
+    Hal_UartClear(3);
+    Modbus_SlaveFrame(3, fbad, sizeof(fbad));
+    if (hal_uart_out_len[3] != 5 || hal_uart_out[3][1] != 0x83 || hal_uart_out[3][2] != MB_EX_ADDRESS)
+        ok = 0;
+
+    /* The answers went out straight from their blocks, which are back in the pool */
+    DGUS_ProcessAllUarts();
+    if (pool_used != UART2_ENABLE + UART3_ENABLE + UART4_ENABLE + UART5_ENABLE)
+        ok = 0;
+    return ok;
+}
+
+/*
+ * Queued blocks wait for the frame being composed, then go out whole in
+ * class order (a routed frame before an upload queued earlier) and back to
+ * the pool
+ */
+static int bench_tx_blocks(void)
+{
+    __xdata u8 *low = Pool_Alloc(POOL_OWNER_APP);
+    __xdata u8 *high = Pool_Alloc(POOL_OWNER_APP);
+    u8 used = pool_used;
+    int ok;
+
+    if (!low || !high)
+        return 0;
+    low[0] = 0x11;
+    low[1] = 0x22;
+    high[0] = 0x33;
+    Hal_UartClear(3);
+    uart_4_5_pin_ctrl(3, 1);
+    uart_send_byte(3, 0xA1);
+    ok = uart_send_block(3, low, 2, UART_TX_LOW);
+    ok = ok && uart_send_block(3, high, 1, UART_TX_HIGH);
+    uart_send_byte(3, 0xA2);
+    ok = ok && hal_uart_out_len[3] == 2;
+    uart_4_5_release(3);
+    DGUS_ProcessAllUarts(); // returns the sent blocks
+    return ok && hal_uart_out_len[3] == 5 && hal_uart_out[3][1] == 0xA2 && hal_uart_out[3][2] == 0x33 &&
+           hal_uart_out[3][3] == 0x11 && hal_uart_out[3][4] == 0x22 && pool_used == used - 2;
+}
+
+/*
+ * A burst past the ring depth loses nothing: the oldest events are handled
+ * to make room. A write that fails its CRC posts no event.
+ */
+static int bench_events(void)
+{
+    u16 cap = RING_CAP(EVENT_QUEUE_LEN), dropped = evt_dropped, i;
+    evt_t ev;
+
+    while (Event_Pop(&ev))
+        ;
+    for (i = 0; i < cap + 8; i++)
+        Event_Post(2, EVT_CMD_WRITE, BENCH_VP + i, i, 0);
+    if (evt_dropped != dropped || Event_Pending() != cap || !Event_Pop(&ev) || ev.vp != BENCH_VP + 8)
+        return 0;
+    while (Event_Pop(&ev))
+        ;
+    if (ev.vp != BENCH_VP + cap + 7)
+        return 0;
+
+    /* A CRC-checked 0x82 write to a watched VP posts its event only if the CRC matches */
+    {
+        static u8 f82[] = {0x5A, 0xA5, 0x07, 0x82, 0x21, 0x00, 0x12, 0x34, 0, 0};
+        u16 crc = crc16table(f82 + 3, 5), n = sizeof(f82);
+
+        f82[8] = (u8)crc;
+        f82[9] = (u8)(crc >> 8) ^ 0x01; // corrupted
+        DGUS_ParseUartFrame(f82, &n, 2, 0, 1);
+        if (Event_Pending() || hal_dgus_ram[0x2100] == 0x1234)
+            return 0;
+        f82[9] ^= 0x01;
+        DGUS_ParseUartFrame(f82, &n, 2, 0, 1);
+        if (!Event_Pop(&ev) || ev.vp != 0x2100 || ev.value != 0x1234 || hal_dgus_ram[0x2100] != 0x1234)
+            return 0;
+    }
+    return 1;
+}
+
+#if UART4_NODE
+#define NODE_VP 0x2400 // scratch VPs of the node checks
+
+/* Deliver a frame on UART4 followed by an idle line, then parse */
+static void uart4_frame(const u8 *frame, u16 len)
+{
+    Hal_UartRx(4, frame, len);
+    Hal_Run(6);
+    DGUS_ProcessAllUarts();
+}
+
+/*
+ * RS485 node 7 on UART4: frames for another node never reach the parser,
+ * answers carry the node ID, broadcasts are applied silently, and a frame
+ * cut short does not swallow the next one once the line has been idle
+ */
+static int bench_node(void)
+{
+    /* node 9, then node 7 back to back: only the second is ours */
+    static const u8 two[] = {0x5A, 0xA5, 0x09, 0x05, 0x82, 0x24, 0x00, 0x11, 0x11,
+                             0x5A, 0xA5, 0x07, 0x05, 0x82, 0x24, 0x02, 0x22, 0x22};
+    static const u8 ack[] = {0x5A, 0xA5, 0x07, 0x03, 0x82, 0x4F, 0x4B};
+    static const u8 rd[] = {0x5A, 0xA5, 0x07, 0x04, 0x83, 0x24, 0x02, 0x01};
+    static const u8 rd_ans[] = {0x5A, 0xA5, 0x07, 0x06, 0x83, 0x24, 0x02, 0x01, 0x22, 0x22};
+    static const u8 bc_wr[] = {0x5A, 0xA5, 0xFF, 0x05, 0x82, 0x24, 0x04, 0x33, 0x33};
+    static const u8 bc_rd[] = {0x5A, 0xA5, 0xFF, 0x04, 0x83, 0x24, 0x02, 0x01};
+    static const u8 cut_own[] = {0x5A, 0xA5, 0x07, 0x05, 0x82, 0x24};
+    static const u8 cut_other[] = {0x5A, 0xA5, 0x09, 0x05, 0x82};
+    static const u8 own[] = {0x5A, 0xA5, 0x07, 0x05, 0x82, 0x24, 0x06, 0x44, 0x44};
+    int ok = 1;
+
+    Hal_UartClear(4);
+    uart4_frame(two, sizeof(two));
+    if (hal_dgus_ram[NODE_VP] != 0 || hal_dgus_ram[NODE_VP + 2] != 0x2222 ||
+        hal_uart_out_len[4] != sizeof(ack) || memcmp(hal_uart_out[4], ack, sizeof(ack)))
+        ok = 0;
+
+    Hal_UartClear(4);
+    uart4_frame(rd, sizeof(rd));
+    if (hal_uart_out_len[4] != sizeof(rd_ans) || memcmp(hal_uart_out[4], rd_ans, sizeof(rd_ans)))
+        ok = 0;
+
+    Hal_UartClear(4);
+    uart4_frame(bc_wr, sizeof(bc_wr));
+    uart4_frame(bc_rd, sizeof(bc_rd));
+    if (hal_dgus_ram[NODE_VP + 4] != 0x3333 || hal_uart_out_len[4] != 0)
+        ok = 0;
+
+    /* truncated frames, ours and a foreign one, each followed by a full frame */
+    Hal_UartClear(4);
+    uart4_frame(cut_own, sizeof(cut_own));
+    uart4_frame(own, sizeof(own));
+    if (hal_dgus_ram[NODE_VP + 6] != 0x4444 || hal_uart_out_len[4] != sizeof(ack))
+        ok = 0;
+    hal_dgus_ram[NODE_VP + 6] = 0;
+    Hal_UartClear(4);
+    uart4_frame(cut_other, sizeof(cut_other));
+    uart4_frame(own, sizeof(own));
+    if (hal_dgus_ram[NODE_VP + 6] != 0x4444 || hal_uart_out_len[4] != sizeof(ack))
+        ok = 0;
+    return ok;
+}
+#endif
+
+#if MB_POLL_COUNT
+/*
+ * Modbus master on UART5 (host/mb_poll_bus.txt): device 1 is answered and
+ * its two rows go out as one 8-register request stored to 0x5100..0x5107;
+ * device 2 stays silent, is resent MB_MASTER_RETRIES times, goes offline
+ * and is then only probed every MB_MASTER_OFFLINE_MS.
+ */
+static int bench_master(void)
+{
+    static u8 ans[3 + 16 + 2] = {1, 0x03, 16};
+    u32 dev2_at[8], t;
+    u8 dev2 = 0, i;
+    u16 dev1 = 0;
+    int ok = 1;
+
+    for (i = 0; i < 16; i++)
+        ans[3 + i] = (u8)(0x10 + i);
+    mb_crc(ans, sizeof(ans));
+
+    Hal_UartClear(5);
+    for (t = 0; t < 3000; t++)
+    {
+        Hal_Run(1);
+        DGUS_ProcessAllUarts();
+        Modbus_MasterTask();
+        if (hal_uart_out_len[5] < 8)
+            continue;
+        if (hal_uart_out_len[5] != 8 || crc16table(hal_uart_out[5], 6) != (hal_uart_out[5][7] << 8 | hal_uart_out[5][6]))
+            ok = 0;
+        if (hal_uart_out[5][0] == 1)
+        {
+            if (hal_uart_out[5][3] != 0x00 || hal_uart_out[5][5] != 8) // rows merged
+                ok = 0;
+            dev1++;
+            Hal_UartRx(5, ans, sizeof(ans));
+        }
+        else if (dev2 < 8)
+            dev2_at[dev2++] = t;
+        Hal_UartClear(5);
+    }
+
+    if (MB_POLL_COUNT != 2 || dev1 < 10 || mb_dev[0].offline || mb_dev[0].ok < dev1 - 1)
+        ok = 0;
+    if (hal_dgus_ram[0x5100] != 0x1011 || hal_dgus_ram[0x5107] != 0x1E1F)
+        ok = 0;
+    /* first send + retries, each after the answer timeout, then probes only */
+    if (dev2 < MB_MASTER_RETRIES + 2 || !mb_dev[1].offline || mb_dev[1].timeouts < MB_MASTER_RETRIES + 1)
+        return 0;
+    for (i = 1; i <= MB_MASTER_RETRIES; i++)
+        if (dev2_at[i] - dev2_at[i - 1] < MB_MASTER_TIMEOUT_MS)
+            ok = 0;
+    if (dev2_at[i] - dev2_at[i - 1] < MB_MASTER_OFFLINE_MS)
+        ok = 0;
+    return ok;
+}
+#endif
+
+/*
+ * A change longer than one upload block goes out in two packets: the
+ * change flags are advanced past the first part instead of being cleared
+ */
+static int bench_monitor_split(void)
+{
+    u8 words = DGUS_READ_WORDS_MAX + 6, k;
+    u16 first;
+    evt_t ev;
+
+    for (k = 0; k < words; k++)
+        hal_dgus_ram[BENCH_VP + k] = 0x100 + k;
+    hal_dgus_ram[0x0F00] = 0x5A00 | (BENCH_VP >> 8);
+    hal_dgus_ram[0x0F01] = (u16)(BENCH_VP & 0xFF) << 8 | words;
+    Hal_UartClear(2);
+    DGUS_MonitorAndSendUpdates();
+    DGUS_ProcessAllUarts(); // returns the sent packet
+    first = hal_uart_out[2][2] + 3u;
+    if (hal_uart_out_len[2] != first || hal_uart_out[2][6] != DGUS_READ_WORDS_MAX ||
+        hal_dgus_ram[0x0F00] != (0x5A00 | (BENCH_VP + DGUS_READ_WORDS_MAX) >> 8) ||
+        hal_dgus_ram[0x0F01] != ((u16)((BENCH_VP + DGUS_READ_WORDS_MAX) & 0xFF) << 8 | 6))
+        return 0;
+    DGUS_MonitorAndSendUpdates();
+    DGUS_ProcessAllUarts();
+    while (Event_Pop(&ev))
+        ;
+    return hal_uart_out_len[2] == first + 2 * 6 + 7 && hal_uart_out[2][first + 5] == (u8)(BENCH_VP + DGUS_READ_WORDS_MAX) &&
+           hal_uart_out[2][first + 6] == 6 && hal_uart_out[2][first + 8] == (u8)(0x100 + DGUS_READ_WORDS_MAX) &&
+           hal_dgus_ram[0x0F00] == 0 && hal_dgus_ram[0x0F01] == 0;
+}
+
+static void bench_monitor(void)
+{
+    double t0;
+    u32 n = iterations / 10 + 1, i;
+    evt_t ev;
+
+    t0 = now_ns();
+    for (i = 0; i < n; i++)
+    {
+        hal_dgus_ram[0x2100] = (u16)i; // a watched VP changes on the "panel"
+        DGUS_MonitorAndSendUpdates();
+        while (Event_Pop(&ev))
+            ;
+    }
+    report("DGUS_MonitorAndSendUpdates", now_ns() - t0, n);
+}
+
+int main(int argc, char **argv)
+{
+    int ok, init_ok, mb_ok, tx_ok, evt_ok, mon_ok, node_ok = 1, master_ok = 1;
+
+    if (argc > 1)
+        iterations = (u32)strtoul(argv[1], 0, 0);
+    if (!iterations)
+        iterations = 1;
+
+    Hal_Init();
+    Sys_Init();
+    Uart_Init();
+
+    printf("T5L host HAL, %u iterations\n", iterations);
+    bench_crc();
+    bench_vp();
+    init_ok = bench_vp_init();
+    ok = bench_frames();
+    mb_ok = bench_modbus();
+    tx_ok = bench_tx_blocks();
+    evt_ok = bench_events();
+    mon_ok = bench_monitor_split();
+#if UART4_NODE
+    node_ok = bench_node();
+#endif
+#if MB_POLL_COUNT
+    master_ok = bench_master();
+#endif
+    bench_monitor();
+    printf("  frame round trip: %s\n", ok ? "ok" : "MISMATCH");
+    printf("  boot VP table: %s\n", init_ok ? "ok" : "MISMATCH");
+    printf("  modbus slave: %s\n", mb_ok ? "ok" : "MISMATCH");
+    printf("  tx block queue: %s\n", tx_ok ? "ok" : "MISMATCH");
+    printf("  event queue: %s\n", evt_ok ? "ok" : "MISMATCH");
+    printf("  monitor split: %s\n", mon_ok ? "ok" : "MISMATCH");
+#if UART4_NODE
+    printf("  rs485 node: %s\n", node_ok ? "ok" : "MISMATCH");
+#endif
+#if MB_POLL_COUNT
+    printf("  modbus master: %s\n", master_ok ? "ok" : "MISMATCH");
+#endif
+    printf("  frame pool: %u/%u blocks in use, high-water %u\n", pool_used, POOL_BLOCKS, pool_hwm);
+    printf("  virtual time: %u ms\n", hal_ms);
+    return (ok && init_ok && mb_ok && tx_ok && evt_ok && mon_ok && node_ok && master_ok) ? 0 : 1;
+}
@@ -9,17 +9,45 @@
  *                upload, CRC). Uses a clean, consistent naming scheme and keeps
  *                backward-compatibility aliases for legacy macros.
  * ----------------------------------------------------------------------------- */
+#ifndef __CONFIG_H__
+#define __CONFIG_H__
+
 #define SELECT_RTC_TYPE 0 // RX8130=1;SD2058=2 ;No RTC=0
 
+#define I2C_ASYNC 1          // 1 = Timer1-driven I2C engine (non-blocking), 0 = blocking bit-bang
+#define I2C_QUEUE_LEN 4      // Pending I2C transactions (power of two, I2C_ASYNC only)
+#define I2C_SPEED_KHZ 100    // RTC I2C bus clock, 100 or 400 (kHz); 400 needs I2C_ASYNC 0
+#define I2C_CLOCK_STRETCH 0  // 1 = open-drain SCL with clock stretching (needs SCL pull-up), 0 = push-pull SCL
+#define I2C_STRETCH_US 1000  // Max time a slave may hold SCL low before I2C_TIMEOUT
+
 #define UART2_ENABLE 1 // T5L serial port 2 open and close settings, 1 opens, 0 closes
 #define UART3_ENABLE 1 // T5L serial port 3 open and close settings, 1 opens, 0 closes
 #define UART4_ENABLE 1 // T5L serial port 4 open and close settings, 1 to open, 0 to close
 #define UART5_ENABLE 1 // T5L serial port 5 open and close settings, 1 opens, 0 closes
 
-#define UART2_RX_LENTH 1024 // T5L serial port 2 receive array length
-#define UART3_RX_LENTH 1024 // T5L serial port 3 receive array length
-#define UART4_RX_LENTH 1024 // T5L serial port 4 receive array length
-#define UART5_RX_LENTH 1024 // T5L serial port 5 receive array length
+#define UART2_PROTO 0 // Serial port 2 protocol: 0 = DGUS 5A A5 frames, 1 = Modbus RTU slave, 2 = Modbus RTU master
+#define UART3_PROTO 0 // Serial port 3 protocol: 0 = DGUS 5A A5 frames, 1 = Modbus RTU slave, 2 = Modbus RTU master
+#define UART4_PROTO 0 // Serial port 4 protocol: 0 = DGUS 5A A5 frames, 1 = Modbus RTU slave, 2 = Modbus RTU master
+#define UART5_PROTO 0 // Serial port 5 protocol: 0 = DGUS 5A A5 frames, 1 = Modbus RTU slave, 2 = Modbus RTU master
+
+#define UART4_NODE 0 // RS485 node address on UART4 (1..254): DGUS frames carry it as 5A A5 ID LEN ..., 0 = no address byte
+#define UART5_NODE 0 // RS485 node address on UART5 (1..254): DGUS frames carry it as 5A A5 ID LEN ..., 0 = no address byte
+
+#define MODBUS_SLAVE_ID 1       // Modbus RTU slave address (1..247)
+#define MODBUS_VP_BASE 0x5000   // VP of holding register 0
+#define MODBUS_REG_COUNT 0x0100 // Holding registers mapped (VP window MODBUS_VP_BASE..+count-1)
+#define MB_MASTER_TIMEOUT_MS 100  // Master: answer timeout per request, from queuing it
+#define MB_MASTER_RETRIES 2       // Master: resends before a device is marked offline
+#define MB_MASTER_OFFLINE_MS 2000 // Master: probe interval of an offline device
+
+#define UART_TX_RING 64 // TX ring per UART (power of two, 2..256), drained by the TX interrupt
+#define UART_TXQ_LEN 4  // Pool blocks (routed frames, Modbus answers) queued for sending per UART (power of two, 2..256)
+
+#define POOL_BLOCK_SIZE 264 // Frame-buffer block (lib/pool): largest DGUS frame (258) + slack, also the frame size limit per port
+#define POOL_BLOCKS 10      // Blocks in the shared pool (NOINIT XRAM, see NOINIT_SIZE in the Makefile)
+#define POOL_QUOTA_UART 4   // Blocks one UART may hold: RX ring, frame being collected, 0x83 or Modbus answer, routed frame being sent
+#define POOL_QUOTA_MON 1    // DGUS monitor upload packet
+#define POOL_QUOTA_APP 2    // Application / logging
 
 #define BAUD_UART2 115200 // T5L serial port 2 baud rate setting
 #define BAUD_UART3 115200 // T5L serial port 3 baud rate setting
@@ -36,4 +64,49 @@
 #define DATA_UPLOAD_UART4 1 // Serial port 4 data automatic upload setting, 1 to upload, 0 not to upload
 #define DATA_UPLOAD_UART5 1 // Serial port 5 data automatic upload setting, 1 uploads, 0 does not upload
 
-#define USE_CRC 0 // Whether to use CRC check, 1 is used, 0 is not used
\ No newline at end of file
+#define USE_CRC 0 // Whether to use CRC check, 1 is used, 0 is not used
+
+#define EVENT_QUEUE_LEN 32 // VP/UART change event ring depth (power of two, 2..256)
+
+#define SCHED_MAX_TASKS 10     // Cooperative scheduler task slots
+#define MONITOR_PERIOD_MS 100  // DGUS auto-upload monitor period
+#define RTC_PERIOD_MS 500      // RTC time-set VP poll / failed read retry period
+#define RTC_POLL_MS 2          // RTC_Service() period: clock update, starts reads, picks up finished ones
+#define RTC_RESYNC_MIN 10      // Hardware RTC read interval; the software clock runs in between
+#define CLOCK_DRIFT_MIN_S 3600UL       // RTC span before a drift estimate (1 s resolution: < 278 ppm error)
+#define CLOCK_DRIFT_MAX_PPM 500UL      // Clamp of the drift correction
+#define CLOCK_BASELINE_MAX_S 2592000UL // Restart the drift baseline after 30 days (ms count wraps at 49)
+#define APP_PERIOD_MS 10       // App_Task() period
+#define LOAD_PERIOD_MS 1000    // Idle/busy load window (sched_load_pct)
+#define IDLE_ENABLE 1          // 1 = PCON idle between ticks when there is no work, 0 = spin
+
+#define VP_INIT_NOR 0              // 1 = boot VP table (src/app/vp_init.txt) applied from a NOR copy, 0 = __code bursts
+#define VP_INIT_NOR_ADDR 0x010000UL // NOR address of that copy (stamp + runs), written once on a stamp mismatch
+#define VP_INIT_SCRATCH_VP 0x7FFE   // 2 free VPs to stage the NOR stamp
+
+#define PROFILE_ENABLE 0      // Hot-path cycle profiling on Timer0, 1 enables, 0 compiles it out
+#define PROF_VP_BASE 0x6000   // Profiling stats VP block (PROF_TAG_COUNT x 7 words)
+#define PROF_EXPORT_MS 1000   // Stats export period to PROF_VP_BASE
+#define PROF_CMD 0xF1         // UART command: 5A A5 02 F1 00 = dump, 5A A5 02 F1 01 = reset
+
+/*
+ * Interrupt priority per T5L group, 0 (lowest) .. 3 (highest). The two sources
+ * of a group always share its level: G0 EX0/UART3, G1 T0/CAN, G2 EX1/UART4-TX,
+ * G3 T1/UART4-RX, G4 UART2/UART5-TX, G5 T2/UART5-RX.
+ */
+#define IRQ_PRIO_G0 2 // UART3 RX/TX
+#define IRQ_PRIO_G1 0 // Timer0 (profiling clock) / CAN
+#define IRQ_PRIO_G2 1 // UART4 TX
+#define IRQ_PRIO_G3 2 // UART4 RX
+#define IRQ_PRIO_G4 2 // UART2 RX/TX, UART5 TX
+#define IRQ_PRIO_G5 2 // Timer2 tick, UART5 RX
+#define IRQ_BANK_RX 1 // Register bank for UART RX ISRs + Timer2_ISR (1..3), 0 = push/pop
+#define IRQ_LATENCY_MEASURE 0 // Record Timer2_ISR entry latency (min/max/late count)
+#define IRQ_LAT_LIMIT_US 86   // "Late" threshold: one 10-bit character at 115200
+
+/* Host test configurations (Makefile host target) layer their settings on top */
+#ifdef T5L_HOST_CONFIG
+#include T5L_HOST_CONFIG
+#endif
+
+#endif /* __CONFIG_H__ */
@@ -0,0 +1,60 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : hal.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Hardware abstraction hooks for the few places where the
+ *                libraries wait on hardware. On the T5L they expand to the
+ *                SFR handshakes; with T5L_HOST (make host) they drive the
+ *                simulated DGUS RAM, UARTs and Timer2 in host/hal_host.c,
+ *                with T5L_SIM (make bench) the 8051 model in bench/hal_sim.c.
+ * ----------------------------------------------------------------------------- */
+#ifndef __HAL_H__
+#define __HAL_H__
+
+#include "t5l1.h"
+
+#ifdef T5L_HOST
+
+#define HAL_DGUS_WAIT_ACK() ((void)0)      // model is always ready
+#define HAL_DGUS_KICK() Hal_DgusKick()     // run the access now
+#define HAL_UART_TX(n) Hal_UartTx(n)       // byte out, TX interrupt now
+#define HAL_WAIT_TICK() Hal_Step()         // waiting on the tick: advance 1 ms
+
+#elif defined(T5L_SIM)
+
+/* ucsim runs the real 8051 code but has no DGUS core and no T5L Timer2 */
+void Hal_SimDgusKick(void);
+void Hal_SimTick(void);
+
+#define HAL_DGUS_WAIT_ACK() ((void)0)      // model is always ready
+#define HAL_DGUS_KICK() Hal_SimDgusKick()  // run the access on the XRAM model
+#define HAL_UART_TX(n) (Busy##n = 0, TX_K##n = 0, TQ_T##n = TQ_H##n, TL_T##n = TL_H##n) // all gone, no TX interrupt
+#define HAL_WAIT_TICK() Hal_SimTick()      // waiting on the tick: advance 1 ms
+
+#else
+
+/* DGUS RAM interface ready for the next request */
+#define HAL_DGUS_WAIT_ACK() \
+    do                      \
+    {                       \
+    } while (!APP_ACK)
+
+/* Start the access set up in RAMMODE/ADR/DATA and wait until it is done */
+#define HAL_DGUS_KICK()    \
+    do                     \
+    {                      \
+        APP_EN = 1;        \
+        while (APP_EN)     \
+            ;              \
+        while (!APP_ACK)   \
+            ;              \
+    } while (0)
+
+#define HAL_UART_TX(n) ((void)0) // hardware raises TIx itself
+#define HAL_WAIT_TICK() ((void)0) // Timer2_ISR advances the tick
+
+#endif
+
+#endif
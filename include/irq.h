@@ -0,0 +1,41 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : irq.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Interrupt priority and register bank setup derived from the
+ *                IRQ_* map in config.h. Sys_Init() loads IRQ_IP0 / IRQ_IP1;
+ *                the hot ISRs are declared with IRQ_USING_RX.
+ * ----------------------------------------------------------------------------- */
+#ifndef __IRQ_H__
+#define __IRQ_H__
+
+#include "config.h"
+
+/* Level n of group g: IP0.g = bit 0 of n, IP1.g = bit 1 of n (3 = highest) */
+#define IRQ_IP_BIT(g, lvl, b) ((((lvl) >> (b)) & 1) << (g))
+#define IRQ_IP(b) (IRQ_IP_BIT(0, IRQ_PRIO_G0, b) | IRQ_IP_BIT(1, IRQ_PRIO_G1, b) | \
+                   IRQ_IP_BIT(2, IRQ_PRIO_G2, b) | IRQ_IP_BIT(3, IRQ_PRIO_G3, b) | \
+                   IRQ_IP_BIT(4, IRQ_PRIO_G4, b) | IRQ_IP_BIT(5, IRQ_PRIO_G5, b))
+#define IRQ_IP0 IRQ_IP(0)
+#define IRQ_IP1 IRQ_IP(1)
+
+/*
+ * ISRs that share a register bank must never preempt each other, so every
+ * group hosting one of them (UART3 G0, UART4-RX G3, UART2 G4, T2/UART5-RX G5)
+ * has to sit on the same level. Bank 0 belongs to main().
+ */
+#if IRQ_BANK_RX
+#if IRQ_BANK_RX > 3
+#error "IRQ_BANK_RX must be 0..3"
+#endif
+#if IRQ_PRIO_G0 != IRQ_PRIO_G3 || IRQ_PRIO_G0 != IRQ_PRIO_G4 || IRQ_PRIO_G0 != IRQ_PRIO_G5
+#error "IRQ_BANK_RX: G0, G3, G4 and G5 must share one priority level"
+#endif
+#define IRQ_USING_RX __using(IRQ_BANK_RX)
+#else
+#define IRQ_USING_RX
+#endif
+
+#endif
@@ -0,0 +1,59 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : mem.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Memory placement classes. --model-large puts everything in
+ *                XDATA (MOVX through DPTR); state an ISR touches on every
+ *                interrupt is declared MEM_HOT / MEM_WARM instead so it is a
+ *                direct / @R0 access. The Makefile checks the placement of
+ *                the global ones (HOT_SYMS) in the linker map.
+ *                The frame-buffer pool (lib/pool) sits in the NOINIT area at
+ *                the top of XRAM, outside what the linker (and so gsinit)
+ *                sees, and is not cleared at boot.
+ * ----------------------------------------------------------------------------- */
+#ifndef __MEM_H__
+#define __MEM_H__
+
+#include "config.h"
+
+/*
+ * Direct DATA (0x08-0x7F, shared with register banks, bit area and the
+ * SDCC temporaries): small ISR counters and flags read or written on every
+ * interrupt. Keep the total to a few dozen bytes; the stack lives above it.
+ */
+#define MEM_HOT __data
+
+/* Indirect IDATA (0x80-0xFF, shared with the stack): wider ISR state */
+#define MEM_WARM __idata
+
+/* XDATA: buffers, tables and state used from main() only (model default) */
+#define MEM_BULK __xdata
+
+/*
+ * NOINIT: XRAM from NOINIT_BASE to 0xFFFF. The Makefile links XDATA with
+ * --xram-size 0x8000 - NOINIT_SIZE, so gsinit neither clears nor copies it
+ * and the contents survive a watchdog reset. Only for buffers whose users
+ * never read a byte before writing it (a fill count or length says how much
+ * is valid). Use as: MEM_NOINIT(NOINIT_xxx) u8 buf[...];
+ */
+#ifndef NOINIT_SIZE
+#define NOINIT_SIZE 0x0B00 // normally passed by the Makefile
+#endif
+#define NOINIT_BASE (0x10000UL - NOINIT_SIZE)
+
+#define NOINIT_POOL NOINIT_BASE // lib/pool frame-buffer blocks
+#define NOINIT_END (NOINIT_POOL + POOL_BLOCKS * POOL_BLOCK_SIZE)
+
+#if NOINIT_END > 0x10000UL
+#error "NOINIT buffers do not fit in NOINIT_SIZE (Makefile)"
+#endif
+
+#ifdef T5L_HOST
+#define MEM_NOINIT(addr) // plain arrays on the host
+#else
+#define MEM_NOINIT(addr) __xdata __at(addr)
+#endif
+
+#endif
@@ -0,0 +1,55 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : ring.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Single-producer / single-consumer ring primitive for the
+ *                ISR <-> main handoff (UART RX/TX, event queue, logging).
+ *                Macros only, so ISRs that must not call functions can use
+ *                them too.
+ * ----------------------------------------------------------------------------- */
+#ifndef __RING_H__
+#define __RING_H__
+
+#include "t5l1.h"
+
+/*
+ * A ring is a storage array of SIZE slots (power of two, 2..256) plus two
+ * free-running u8 indices: head, written only by the producer, and tail,
+ * written only by the consumer. Slot = index & (SIZE - 1).
+ *  - Each side stores its index after the slot itself is complete, and a
+ *    one-byte store is atomic on the 8051, so neither side masks EA.
+ *  - Keep the indices of ISR rings in MEM_HOT (direct DATA), so an update
+ *    is a single INC.
+ *  - SIZE 256 holds 255 entries, because head == tail must stay "empty".
+ *    With SIZE 256 the slot is the index itself and no AND is generated.
+ * Producer: if (!RING_FULL(h, t, S)) RING_PUT(buf, h, S, v);
+ * Consumer: if (!RING_EMPTY(h, t)) RING_GET(buf, t, S, v);
+ * Record rings: fill buf[RING_SLOT(h, S)] field by field, then h++.
+ */
+#define RING_SIZE_OK(size) ((size) >= 2 && (size) <= 256 && !((size) & ((size) - 1)))
+#define RING_CAP(size) ((size) == 256 ? 255 : (size)) // entries a ring can hold
+
+#define RING_SLOT(idx, size) ((u8)((idx) & ((size) - 1)))
+#define RING_COUNT(head, tail) ((u8)((head) - (tail)))
+#define RING_EMPTY(head, tail) ((head) == (tail))
+#define RING_FULL(head, tail, size) (RING_COUNT(head, tail) >= RING_CAP(size))
+
+/* Write v into the head slot, then publish it (producer side only) */
+#define RING_PUT(buf, head, size, v)           \
+    do                                         \
+    {                                          \
+        (buf)[RING_SLOT(head, size)] = (v);    \
+        (head)++;                              \
+    } while (0)
+
+/* Read the tail slot into v, then release it (consumer side only) */
+#define RING_GET(buf, tail, size, v)           \
+    do                                         \
+    {                                          \
+        (v) = (buf)[RING_SLOT(tail, size)];    \
+        (tail)++;                              \
+    } while (0)
+
+#endif
@@ -8,9 +8,16 @@
  *    T5L/T5L51 special function register (SFR) and bit mapping definitions
  *    for use with the SDCC compiler. Provides compatibility macros for
  *    IntelliSense and unified naming for DGUS and peripheral control.
+ *    With T5L_HOST the same names map onto host/hal_host.h instead.
  * ----------------------------------------------------------------------------- */
 #ifndef __T5L1_H__
 #define __T5L1_H__
+
+#ifdef T5L_HOST
+/* Host build (make host): sized types, SDCC keywords and simulated SFRs */
+#include "hal_host.h"
+#else
+
 #define u8 unsigned char
 #define s8 signed char
 #define u16 unsigned int
@@ -45,6 +52,9 @@
 #ifndef __interrupt
 #define __interrupt(x)
 #endif
+#ifndef __using
+#define __using(x)
+#endif
 #endif
 /* --------------------------------------------------------------- */
 
@@ -179,6 +189,8 @@ __sfr __at(0x8F) CAN_CR;
 __sfr __at(0x91) CAN_IR;
 __sfr __at(0xE8) CAN_ET;
 
+#endif // T5L_HOST
+
 // Definition of system main frequency and 1ms timing value
 #define DTHD1 0X5A // Frame header 1
 #define DTHD2 0XA5 // Frame header 2
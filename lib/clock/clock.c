@@ -0,0 +1,168 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : clock.c / clock.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Software calendar clock (2000..2099) on the Timer2 uptime.
+ *                Advanced by whole seconds from sys_time_ms(), set from the
+ *                hardware RTC by Clock_Sync(); the length of one RTC second
+ *                in Timer2 time is estimated across syncs to cancel drift.
+ * ----------------------------------------------------------------------------- */
+#include "clock.h"
+
+#define CLOCK_US_PER_S 1000000UL
+
+__xdata clock_dt_t clock_now;
+__bit clock_valid = 0;
+__xdata s16 clock_drift_ppm = 0;
+
+/* One RTC second measured in Timer2 microseconds (1000000 = no drift) */
+static __xdata u32 clock_period_us = CLOCK_US_PER_S;
+static __xdata u32 clock_acc_us;  // Timer2 time not yet turned into seconds
+static __xdata u32 clock_last_ms; // sys_time_ms() at the last Clock_Update()
+
+/* Drift baseline: RTC seconds and Timer2 ms at the first sync after a step */
+static __xdata u32 clock_base_s;
+static __xdata u32 clock_base_ms;
+static __bit clock_base_valid = 0;
+
+static __code const u8 clock_mdays[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+static __code const u16 clock_ydays[12] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+
+/* Years 2000..2099: every fourth year is a leap year */
+static u8 clock_month_days(u8 year, u8 month)
+{
+    if (month == 2 && (year & 3) == 0)
+        return 29;
+    return clock_mdays[month - 1];
+}
+
+/**
+ * @brief Range check of a decoded RTC time.
+ * @return 1 if every field is valid (day checked against month and leap year)
+ */
+u8 Clock_Check(const __xdata clock_dt_t *dt)
+{
+    if (dt->year > 99 || dt->month < 1 || dt->month > 12 || dt->week > 6)
+        return 0;
+    if (dt->day < 1 || dt->day > clock_month_days(dt->year, dt->month))
+        return 0;
+    return (dt->hour < 24 && dt->min < 60 && dt->sec < 60) ? 1 : 0;
+}
+
+/**
+ * @brief Seconds since 2000-01-01 00:00:00 (dt must pass Clock_Check()).
+ */
+u32 Clock_ToSeconds(const __xdata clock_dt_t *dt)
+{
+    u16 days;
+
+    days = (u16)dt->year * 365 + (dt->year + 3) / 4 + clock_ydays[dt->month - 1] + dt->day - 1;
+    if (dt->month > 2 && (dt->year & 3) == 0)
+        days++;
+    return (((u32)days * 24 + dt->hour) * 60 + dt->min) * 60 + dt->sec;
+}
+
+/* Estimate the RTC second in Timer2 time over the baseline (main context) */
+static void clock_drift_update(u32 secs, u32 now_ms)
+{
+    u32 ds, dms, period;
+
+    /* Measure against the baseline unless it is missing, the RTC went
+       backwards, or now_ms - base would come close to the 32-bit wrap */
+    if (clock_base_valid && secs >= clock_base_s && secs - clock_base_s <= CLOCK_BASELINE_MAX_S)
+    {
+        ds = secs - clock_base_s;
+        if (ds < CLOCK_DRIFT_MIN_S)
+            return; // 1 s RTC resolution: too short to measure
+
+        dms = now_ms - clock_base_ms;
+        period = (dms / ds) * 1000UL + ((dms % ds) * 1000UL) / ds;
+        if (period > CLOCK_US_PER_S + CLOCK_DRIFT_MAX_PPM)
+            period = CLOCK_US_PER_S + CLOCK_DRIFT_MAX_PPM;
+        else if (period < CLOCK_US_PER_S - CLOCK_DRIFT_MAX_PPM)
+            period = CLOCK_US_PER_S - CLOCK_DRIFT_MAX_PPM;
+        clock_period_us = period;
+        clock_drift_ppm = (s16)(period - CLOCK_US_PER_S); // 1 us per second = 1 ppm
+        return;
+    }
+
+    clock_base_s = secs;
+    clock_base_ms = now_ms;
+    clock_base_valid = 1;
+}
+
+/**
+ * @brief Set the clock from the hardware RTC.
+ * @param dt   decoded RTC time (ignored if it fails Clock_Check())
+ * @param step 1 when the time was just written (user set), so the jump is
+ *             not mistaken for drift; 0 for a plain periodic resync
+ */
+void Clock_Sync(const __xdata clock_dt_t *dt, u8 step)
+{
+    u32 now_ms, secs;
+
+    if (!Clock_Check(dt))
+        return;
+
+    now_ms = sys_time_ms();
+    secs = Clock_ToSeconds(dt);
+    if (step)
+        clock_base_valid = 0;
+    clock_drift_update(secs, now_ms);
+
+    clock_now = *dt;
+    clock_last_ms = now_ms;
+    clock_acc_us = 0;
+    clock_valid = 1;
+}
+
+/* Advance clock_now by one second with calendar carries */
+static void clock_tick(void)
+{
+    __xdata clock_dt_t *t = &clock_now;
+
+    if (++t->sec < 60)
+        return;
+    t->sec = 0;
+    if (++t->min < 60)
+        return;
+    t->min = 0;
+    if (++t->hour < 24)
+        return;
+    t->hour = 0;
+    t->week = (t->week < 6) ? t->week + 1 : 0;
+    if (++t->day <= clock_month_days(t->year, t->month))
+        return;
+    t->day = 1;
+    if (++t->month <= 12)
+        return;
+    t->month = 1;
+    t->year = (t->year < 99) ? t->year + 1 : 0;
+}
+
+/**
+ * @brief Advance clock_now by the Timer2 time elapsed since the last call,
+ *        one drift-corrected second per clock_period_us.
+ * @return 1 if at least one second passed (clock_now changed)
+ */
+u8 Clock_Update(void)
+{
+    u32 now;
+    u8 ticked = 0;
+
+    if (!clock_valid)
+        return 0;
+
+    now = sys_time_ms();
+    clock_acc_us += (now - clock_last_ms) * 1000UL;
+    clock_last_ms = now;
+    while (clock_acc_us >= clock_period_us)
+    {
+        clock_acc_us -= clock_period_us;
+        clock_tick();
+        ticked = 1;
+    }
+    return ticked;
+}
@@ -0,0 +1,40 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : clock.c / clock.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Software calendar clock (2000..2099) on the Timer2 uptime.
+ *                Advanced by whole seconds from sys_time_ms(), set from the
+ *                hardware RTC by Clock_Sync(); the length of one RTC second
+ *                in Timer2 time is estimated across syncs to cancel drift.
+ * ----------------------------------------------------------------------------- */
+#ifndef __CLOCK_H__
+#define __CLOCK_H__
+
+#include "t5l1.h"
+#include "config.h"
+#include "timer.h"
+
+/* Decimal date and time; same field order as the DGUS RTC VPs 0x0010.. */
+typedef struct
+{
+    u8 year;  // 0..99 -> 2000..2099
+    u8 month; // 1..12
+    u8 day;   // 1..31
+    u8 week;  // 0..6, convention of the RTC backend (carried over, +1 per day)
+    u8 hour;  // 0..23
+    u8 min;   // 0..59
+    u8 sec;   // 0..59
+} clock_dt_t;
+
+extern __xdata clock_dt_t clock_now;  // current time (valid once clock_valid)
+extern __bit clock_valid;             // set by the first Clock_Sync()
+extern __xdata s16 clock_drift_ppm;   // Timer2 vs RTC: + = Timer2 runs fast
+
+u8 Clock_Check(const __xdata clock_dt_t *dt);
+u32 Clock_ToSeconds(const __xdata clock_dt_t *dt);
+void Clock_Sync(const __xdata clock_dt_t *dt, u8 step);
+u8 Clock_Update(void);
+
+#endif
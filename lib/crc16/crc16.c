@@ -9,10 +9,12 @@
  * ----------------------------------------------------------------------------- */
 
 #include "crc16.h"
+#include "prof.h"
 
 u16 crc16table(u8 *ptr, u16 len)
 {
 	u16 crc = 0xFFFF; // initial value per MODBUS spec
+	PROF_BEGIN(PROF_CRC16);
 	while (len--)
 	{
 		crc ^= (u16)(*ptr++);
@@ -28,5 +30,6 @@ u16 crc16table(u8 *ptr, u16 len)
 			}
 		}
 	}
+	PROF_END(PROF_CRC16);
 	return crc; // LSB first when transmitted
 }
@@ -0,0 +1,134 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : event.c / event.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Lossless VP/UART change event queue.
+ *                Single-producer/single-consumer ring fed by the DGUS monitor
+ *                and the UART frame parser; Event_Dispatch() hands each event
+ *                to the handler registered for its watch range.
+ * ----------------------------------------------------------------------------- */
+#include "event.h"
+#include "timer.h"
+#include "watch_table.h"
+
+/* Record ring (include/ring.h): the producer fills the slot, then moves evt_head */
+static __xdata evt_t evt_ring[EVENT_QUEUE_LEN];
+static volatile __xdata u8 evt_head = 0; // next slot to write (producer)
+static volatile __xdata u8 evt_tail = 0; // next slot to read (consumer)
+volatile __xdata u16 evt_dropped = 0;
+static __xdata evt_t evt_cur; // event being handled, or the one waiting for a slot
+static __bit evt_busy = 0;    // a handler is running
+
+/* Run the handler registered for the watch range of evt_cur */
+static void evt_run(void)
+{
+    watch_handler_t handler = 0;
+
+    if (evt_cur.src == EVT_SRC_MONITOR)
+    {
+#if VP_WATCH_COUNT
+        handler = VP_Watch_Handler[evt_cur.watch];
+#endif
+    }
+    else
+    {
+#if UART_WATCH_COUNT
+        handler = Uart_Watch_Handler[evt_cur.watch];
+#endif
+    }
+    if (handler)
+        handler(&evt_cur);
+}
+
+/**
+ * @brief Append one change event to the ring.
+ *
+ * Producer and consumer both run in the main loop, so a full ring is not a
+ * reason to lose an event: the oldest one is handed to its handler right
+ * here, which frees its slot and keeps the order. Only an event posted by a
+ * handler while the ring is full is dropped (evt_dropped); its change flag
+ * has already been raised by the caller.
+ *
+ * @param src   EVT_SRC_MONITOR or UART number (2..5)
+ * @param cmd   EVT_CMD_* kind
+ * @param vp    VP address
+ * @param value New word (change/write) or word count (read)
+ * @param watch Watch-table index of the matched range
+ */
+void Event_Post(u8 src, u8 cmd, u16 vp, u16 value, u16 watch)
+{
+    __xdata evt_t *ev;
+    u8 full = RING_FULL(evt_head, evt_tail, EVENT_QUEUE_LEN);
+
+    if (full)
+    {
+        if (evt_busy)
+        {
+            evt_dropped++; // posted from a handler: the ring cannot drain now
+            return;
+        }
+        /* Take the oldest event out to make room; it runs once the new one
+           is stored, since a handler that posts again reuses the
+           (non-reentrant) argument storage of this function. */
+        evt_cur = evt_ring[RING_SLOT(evt_tail, EVENT_QUEUE_LEN)];
+        evt_tail++;
+    }
+
+    ev = &evt_ring[RING_SLOT(evt_head, EVENT_QUEUE_LEN)];
+    ev->src = src;
+    ev->cmd = cmd;
+    ev->vp = vp;
+    ev->value = value;
+    ev->tick = sys_tick_get();
+    ev->watch = watch;
+    evt_head++; // publish
+
+    if (full)
+    {
+        evt_busy = 1;
+        evt_run();
+        evt_busy = 0;
+    }
+}
+
+/**
+ * @brief Remove the oldest event from the ring.
+ * @param ev Destination
+ * @return 1 if an event was copied, 0 if the ring was empty
+ */
+u8 Event_Pop(evt_t *ev)
+{
+    u8 tail = evt_tail;
+
+    if (RING_EMPTY(evt_head, tail))
+        return 0;
+
+    *ev = evt_ring[RING_SLOT(tail, EVENT_QUEUE_LEN)];
+    evt_tail = tail + 1; // release slot
+    return 1;
+}
+
+/**
+ * @brief Number of events waiting in the ring.
+ */
+u8 Event_Pending(void)
+{
+    return RING_COUNT(evt_head, evt_tail);
+}
+
+/**
+ * @brief Drain the ring and call the handler registered for each event's
+ *        watch range (see src/app/watch_list.txt). Call in main loop.
+ *
+ * Events whose range has no handler are consumed silently; their change flag
+ * is still set for polling code.
+ */
+void Event_Dispatch(void)
+{
+    evt_busy = 1;
+    while (Event_Pop(&evt_cur))
+        evt_run();
+    evt_busy = 0;
+}
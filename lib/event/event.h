@@ -0,0 +1,48 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : event.c / event.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Lossless VP/UART change event queue.
+ *                Single-producer/single-consumer ring fed by the DGUS monitor
+ *                and the UART frame parser; Event_Dispatch() hands each event
+ *                to the handler registered for its watch range.
+ * ----------------------------------------------------------------------------- */
+#ifndef __EVENT_H__
+#define __EVENT_H__
+
+#include "t5l1.h"
+#include "config.h"
+#include "ring.h"
+
+/* Event sources: 0 = DGUS auto-upload monitor, 2..5 = UART port of the frame */
+#define EVT_SRC_MONITOR 0
+
+/* Event kinds */
+#define EVT_CMD_CHANGE 0x00 // VP changed on the panel (monitor); value = new word
+#define EVT_CMD_WRITE 0x82  // host wrote the VP; value = written word
+#define EVT_CMD_READ 0x83   // host read from the VP; value = requested word count
+
+#if !RING_SIZE_OK(EVENT_QUEUE_LEN)
+#error "EVENT_QUEUE_LEN must be a power of two between 2 and 256"
+#endif
+
+typedef struct
+{
+    u8 src;    // EVT_SRC_MONITOR or UART number 2..5
+    u8 cmd;    // EVT_CMD_*
+    u16 vp;    // VP address
+    u16 value; // see EVT_CMD_*
+    u16 tick;  // sys_tick_ms when the change was captured
+    u16 watch; // index into the watch table of the source (handler lookup)
+} evt_t;
+
+extern volatile __xdata u16 evt_dropped; // events posted by a handler while the ring was full
+
+void Event_Post(u8 src, u8 cmd, u16 vp, u16 value, u16 watch);
+u8 Event_Pop(evt_t *ev);
+u8 Event_Pending(void);
+void Event_Dispatch(void);
+
+#endif
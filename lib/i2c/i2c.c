@@ -0,0 +1,620 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : i2c.c / i2c.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Bit-banged I2C master on RTC_SCL (P3.2) / RTC_SDA (P3.3).
+ *                I2C_ASYNC 1: queued transactions stepped one half bit per
+ *                Timer1 interrupt, so the main loop never waits on the bus.
+ *                I2C_ASYNC 0: blocking transfers with bit timing derived from
+ *                FOSC (100 or 400 kHz) and calibrated against Timer2.
+ *                Both support clock stretching and ACK/NACK/timeout results.
+ * ----------------------------------------------------------------------------- */
+#include "i2c.h"
+#include "hal.h"
+#include "mem.h"
+
+#define SDA_MASK 0x08 // P3.3 in RTC_DIR_REG
+#define SCL_MASK 0x04 // P3.2 in RTC_DIR_REG
+
+/* SDA driven by the master (push-pull) / released to the slave (open drain) */
+#define SDA_OUT() (RTC_DIR_REG |= SDA_MASK)
+#define SDA_IN()                  \
+    do                            \
+    {                             \
+        RTC_SDA = 1;              \
+        RTC_DIR_REG &= ~SDA_MASK; \
+    } while (0)
+
+/* SCL push-pull, or open drain when a slave may stretch the clock */
+static void scl_mode(void)
+{
+#if I2C_CLOCK_STRETCH
+    RTC_DIR_REG &= ~SCL_MASK;
+#else
+    RTC_DIR_REG |= SCL_MASK;
+#endif
+    RTC_SCL = 1;
+    SDA_IN();
+}
+
+#if !I2C_ASYNC
+
+/* SCL low / high phase in ns (spec minimum plus margin for the bit-bang code) */
+#if I2C_SPEED_KHZ == 400
+#define I2C_T_LOW_NS 1400
+#define I2C_T_HIGH_NS 1100
+#elif I2C_SPEED_KHZ == 100
+#define I2C_T_LOW_NS 5000
+#define I2C_T_HIGH_NS 5000
+#else
+#error "I2C_SPEED_KHZ must be 100 or 400"
+#endif
+
+/* ns -> Timer2 counts (FOSC/12), rounded up so phases never run short */
+#define I2C_NS_TO_T2(ns) ((u16)(((u32)(ns) * T2_TICKS_PER_MS + 999999UL) / 1000000UL))
+
+#define I2C_CAL_LOOPS 2000 // i2c_wait() iterations timed by I2C_Init()
+
+static __xdata u16 i2c_t_low = 1;    // i2c_wait() loops for the SCL low phase
+static __xdata u16 i2c_t_high = 1;   // i2c_wait() loops for the SCL high phase
+static __xdata u16 i2c_stretch = 1;  // SCL low polls before I2C_TIMEOUT
+static __bit i2c_sda;                // SDA sampled by the last i2c_clock()
+
+/* Calibrated busy wait; one iteration costs (T2 counts / I2C_CAL_LOOPS) */
+static void i2c_wait(u16 n)
+{
+    while (n--)
+        ;
+}
+
+
+/*
+ * Raise SCL. With I2C_CLOCK_STRETCH the pin is open drain (needs a pull-up)
+ * and a slave may hold it low; wait for it up to I2C_STRETCH_US.
+ */
+static u8 scl_high(void)
+{
+    RTC_SCL = 1;
+#if I2C_CLOCK_STRETCH
+    {
+        u16 n = i2c_stretch;
+        while (!RTC_SCL)
+        {
+            if (!n--)
+                return I2C_TIMEOUT;
+            i2c_wait(i2c_t_low);
+        }
+    }
+#endif
+    return I2C_OK;
+}
+
+/* Read TH2:TL2 (high-low-high) */
+static u16 t2_count(void)
+{
+    u8 th, tl;
+
+    th = TH2;
+    tl = TL2;
+    if (TH2 != th)
+    {
+        th = TH2;
+        tl = TL2;
+    }
+    return ((u16)th << 8) | tl;
+}
+
+static u16 i2c_loops(u16 counts, u16 cal)
+{
+    u32 n = ((u32)counts * I2C_CAL_LOOPS + cal - 1) / cal;
+    return (n > 0xFFFF) ? 0xFFFF : (n ? (u16)n : 1);
+}
+
+/**
+ * @brief Calibrate bit timing against Timer2 and release the bus.
+ *
+ * Call after Timer2_Init(). The delay loop is timed once with interrupts
+ * off, so the phases follow FOSC regardless of the code SDCC generates.
+ */
+void I2C_Init(void)
+{
+    u16 t0, t1, cal;
+    __bit ea = EA;
+
+    EA = 0;
+    t0 = t2_count();
+    i2c_wait(I2C_CAL_LOOPS);
+    t1 = t2_count();
+    EA = ea;
+
+    cal = t1 - t0;
+    if (t1 < t0)
+        cal -= (u16)T2_RELOAD; // crossed one reload
+    if (!cal)
+        cal = 1;
+
+    i2c_t_low = i2c_loops(I2C_NS_TO_T2(I2C_T_LOW_NS), cal);
+    i2c_t_high = i2c_loops(I2C_NS_TO_T2(I2C_T_HIGH_NS), cal);
+    i2c_stretch = (u16)((I2C_STRETCH_US * 1000UL + I2C_T_LOW_NS - 1) / I2C_T_LOW_NS);
+
+    scl_mode();
+}
+
+/* START (or repeated START): SDA 1->0 while SCL high */
+static u8 i2c_start(void)
+{
+    SDA_OUT();
+    RTC_SDA = 1;
+    i2c_wait(i2c_t_low);
+    if (scl_high())
+        return I2C_TIMEOUT;
+    i2c_wait(i2c_t_high); // tSU;STA
+    RTC_SDA = 0;
+    i2c_wait(i2c_t_high); // tHD;STA
+    RTC_SCL = 0;
+    return I2C_OK;
+}
+
+/* STOP: SDA 0->1 while SCL high, then release SDA */
+static void i2c_stop(void)
+{
+    SDA_OUT();
+    RTC_SDA = 0;
+    i2c_wait(i2c_t_low);
+    scl_high();
+    i2c_wait(i2c_t_high); // tSU;STO
+    RTC_SDA = 1;
+    i2c_wait(i2c_t_low); // tBUF
+    SDA_IN();
+}
+
+/* One SCL pulse; samples SDA into i2c_sda while high */
+static u8 i2c_clock(void)
+{
+    i2c_wait(i2c_t_low);
+    if (scl_high())
+        return I2C_TIMEOUT;
+    i2c_wait(i2c_t_high);
+    i2c_sda = RTC_SDA;
+    RTC_SCL = 0;
+    return I2C_OK;
+}
+
+/* Write one byte MSB first; I2C_NACK if the slave did not acknowledge */
+static u8 i2c_write_byte(u8 dat)
+{
+    SDA_OUT();
+    for (u8 i = 0; i < 8; i++)
+    {
+        RTC_SDA = (dat & 0x80) ? 1 : 0;
+        dat <<= 1;
+        if (i2c_clock())
+            return I2C_TIMEOUT;
+    }
+    SDA_IN();
+    if (i2c_clock())
+        return I2C_TIMEOUT;
+    return i2c_sda ? I2C_NACK : I2C_OK;
+}
+
+/* Read one byte MSB first, then ACK (more to come) or NACK (last byte) */
+static u8 i2c_read_byte(u8 *dat, __bit ack)
+{
+    u8 v = 0;
+
+    SDA_IN();
+    for (u8 i = 0; i < 8; i++)
+    {
+        if (i2c_clock())
+            return I2C_TIMEOUT;
+        v = (v << 1) | (u8)i2c_sda;
+    }
+    *dat = v;
+
+    SDA_OUT();
+    RTC_SDA = ack ? 0 : 1;
+    return i2c_clock();
+}
+
+/* Blocking register write; STOP is always sent */
+static u8 i2c_write_sync(u8 addr, u8 reg, const u8 *buf, u8 len)
+{
+    u8 st = i2c_start();
+
+    if (st == I2C_OK)
+        st = i2c_write_byte((u8)(addr << 1));
+    if (st == I2C_OK)
+        st = i2c_write_byte(reg);
+    while (st == I2C_OK && len--)
+        st = i2c_write_byte(*buf++);
+    i2c_stop();
+    return st;
+}
+
+/* Blocking register read with repeated START; STOP is always sent */
+static u8 i2c_read_sync(u8 addr, u8 reg, u8 *buf, u8 len)
+{
+    u8 st = i2c_start();
+
+    if (st == I2C_OK)
+        st = i2c_write_byte((u8)(addr << 1));
+    if (st == I2C_OK)
+        st = i2c_write_byte(reg);
+    if (st == I2C_OK)
+        st = i2c_start();
+    if (st == I2C_OK)
+        st = i2c_write_byte((u8)(addr << 1) | 0x01);
+    while (st == I2C_OK && len)
+    {
+        len--;
+        st = i2c_read_byte(buf++, len != 0);
+    }
+    i2c_stop();
+    return st;
+}
+
+/**
+ * @brief Run a transaction to completion (I2C_ASYNC 0: no queue).
+ * @return 1 (always accepted); x->status holds the result on return
+ */
+u8 I2C_Submit(__xdata i2c_xfer_t *x)
+{
+    x->status = x->read ? i2c_read_sync(x->addr, x->reg, x->buf, x->len)
+                        : i2c_write_sync(x->addr, x->reg, x->buf, x->len);
+    return 1;
+}
+
+#else // I2C_ASYNC
+
+#if I2C_SPEED_KHZ != 100
+#error "I2C_ASYNC runs the bus at 100 kHz (one Timer1 interrupt per half bit); set I2C_SPEED_KHZ 100"
+#endif
+
+/* Timer1 mode 2 (8-bit auto-reload, FOSC/12): one interrupt per half bit */
+#define I2C_T1_COUNTS (FOSC / 12UL / 2000UL / I2C_SPEED_KHZ) // 86 counts = 5 us
+#define I2C_T1_RELOAD ((u8)(256 - I2C_T1_COUNTS))
+#define I2C_STRETCH_TICKS ((u16)(I2C_STRETCH_US * I2C_SPEED_KHZ * 2UL / 1000UL))
+
+#define I2C_Q_MASK (I2C_QUEUE_LEN - 1)
+
+#if (I2C_QUEUE_LEN < 2) || (I2C_QUEUE_LEN > 128) || (I2C_QUEUE_LEN & I2C_Q_MASK)
+#error "I2C_QUEUE_LEN must be a power of two between 2 and 128"
+#endif
+
+/* Engine states: one pin action per Timer1 tick */
+enum
+{
+    S_IDLE = 0,
+    S_START_A, // SDA high (SCL may be low for a repeated START)
+    S_START_B, // SCL high
+    S_START_C, // SDA low: START
+    S_START_D, // SCL low, first data bit out
+    S_TX_HIGH, // SCL high, slave samples
+    S_TX_FALL, // SCL low, next bit out or release SDA for ACK
+    S_ACK_HIGH,
+    S_ACK_FALL, // sample ACK, SCL low, pick next step
+    S_RX_HIGH,
+    S_RX_FALL, // sample bit, SCL low
+    S_MACK_HIGH,
+    S_MACK_FALL, // master ACK/NACK done
+    S_STOP_A,    // SDA low
+    S_STOP_B,    // SCL high
+    S_STOP_C,    // SDA high: STOP
+    S_STOP_D     // bus free time, complete
+};
+
+/* Which byte of the sequence was just sent */
+enum
+{
+    STG_ADDR_W = 0, // address + W
+    STG_REG,        // register
+    STG_ADDR_R,     // address + R after repeated START
+    STG_DATA        // write data
+};
+
+/* Queue: main writes i2c_head, Timer1_ISR writes i2c_tail (8-bit, atomic) */
+static __xdata i2c_xfer_t *__xdata i2c_q[I2C_QUEUE_LEN];
+static volatile MEM_HOT u8 i2c_head = 0;
+static volatile MEM_HOT u8 i2c_tail = 0;
+
+/* Engine state, Timer1_ISR only (every half bit: direct DATA) */
+static __xdata i2c_xfer_t *MEM_HOT i2c_cur;
+static MEM_HOT u8 i2c_state = S_IDLE;
+static MEM_HOT u8 i2c_stage;
+static MEM_HOT u8 i2c_byte; // shift register
+static MEM_HOT u8 i2c_bits; // bits left in i2c_byte
+static MEM_HOT u8 i2c_idx;  // data byte index
+static MEM_HOT u8 i2c_result;
+#if I2C_CLOCK_STRETCH
+static MEM_HOT u16 i2c_hold; // stretch ticks left
+static __bit i2c_scl_check;  // SCL was just released
+#endif
+
+/* Raise SCL; the next tick verifies it really went high */
+#if I2C_CLOCK_STRETCH
+#define SCL_RISE()                       \
+    do                                   \
+    {                                    \
+        RTC_SCL = 1;                     \
+        i2c_scl_check = 1;               \
+        i2c_hold = I2C_STRETCH_TICKS;    \
+    } while (0)
+#else
+#define SCL_RISE() (RTC_SCL = 1)
+#endif
+
+/**
+ * @brief Set up Timer1 as the engine clock and release the bus.
+ *
+ * Timer1 runs only while a transaction is queued.
+ */
+void I2C_Init(void)
+{
+    scl_mode();
+    TR1 = 0;
+    TMOD &= 0x0F;
+    TMOD |= 0x20; // Timer1 mode 2 (8-bit auto-reload)
+    TH1 = I2C_T1_RELOAD;
+    TL1 = I2C_T1_RELOAD;
+    ET1 = 1;
+}
+
+/**
+ * @brief Queue a transaction; the engine runs it in the background.
+ *
+ * Fill addr/reg/buf/len/read first. x->status reads I2C_BUSY until the STOP
+ * has been sent, then I2C_OK, I2C_NACK or I2C_TIMEOUT (see I2C_Done()).
+ * x and its buffer must stay valid until then.
+ *
+ * @return 1 if queued, 0 if I2C_QUEUE_LEN transactions are already pending
+ */
+u8 I2C_Submit(__xdata i2c_xfer_t *x)
+{
+    u8 head = i2c_head;
+
+    if ((u8)(head - i2c_tail) >= I2C_QUEUE_LEN)
+        return 0;
+
+    x->status = I2C_BUSY;
+    i2c_q[head & I2C_Q_MASK] = x;
+    i2c_head = head + 1; // publish
+    TR1 = 1;             // wake the engine (it stops itself when idle)
+    return 1;
+}
+
+/* Shift out one byte, first bit now (SCL is low) */
+static void i2c_tx(u8 b)
+{
+    i2c_byte = b;
+    i2c_bits = 8;
+    SDA_OUT();
+    RTC_SDA = (b & 0x80) ? 1 : 0;
+    i2c_state = S_TX_HIGH;
+}
+
+/* Finish the current transaction and release the queue slot */
+static void i2c_complete(void)
+{
+    i2c_cur->status = i2c_result;
+    i2c_tail++;
+    i2c_state = S_IDLE;
+}
+
+/* Next step after an acknowledged byte (SCL low, SDA released) */
+static void i2c_next(void)
+{
+    __xdata i2c_xfer_t *x = i2c_cur;
+
+    switch (i2c_stage)
+    {
+    case STG_ADDR_W:
+        i2c_stage = STG_REG;
+        i2c_tx(x->reg);
+        break;
+    case STG_REG:
+        if (x->read)
+        {
+            i2c_stage = STG_ADDR_R;
+            i2c_byte = (u8)(x->addr << 1) | 0x01;
+            i2c_state = S_START_A; // repeated START
+        }
+        else if (x->len)
+        {
+            i2c_stage = STG_DATA;
+            i2c_idx = 0;
+            i2c_tx(x->buf[0]);
+        }
+        else
+            i2c_state = S_STOP_A;
+        break;
+    case STG_ADDR_R:
+        if (x->len)
+        {
+            i2c_idx = 0;
+            i2c_bits = 8;
+            i2c_state = S_RX_HIGH;
+        }
+        else
+            i2c_state = S_STOP_A;
+        break;
+    default: // STG_DATA
+        if (++i2c_idx < x->len)
+            i2c_tx(x->buf[i2c_idx]);
+        else
+            i2c_state = S_STOP_A;
+        break;
+    }
+}
+
+/**
+ * @brief Advance the bus by one half bit. Called from Timer1_ISR only.
+ */
+void I2C_Tick(void)
+{
+    __xdata i2c_xfer_t *x = i2c_cur;
+
+#if I2C_CLOCK_STRETCH
+    if (i2c_scl_check)
+    {
+        if (!RTC_SCL)
+        {
+            if (--i2c_hold)
+                return; // slave is stretching: hold this state
+            i2c_result = I2C_TIMEOUT;
+            scl_mode(); // SCL stuck low: no STOP possible, release and give up
+            i2c_scl_check = 0;
+            i2c_complete();
+            return;
+        }
+        i2c_scl_check = 0;
+    }
+#endif
+
+    switch (i2c_state)
+    {
+    case S_IDLE:
+        if (i2c_head == i2c_tail)
+        {
+            TR1 = 0; // nothing queued: stop ticking
+            break;
+        }
+        i2c_cur = i2c_q[i2c_tail & I2C_Q_MASK];
+        i2c_result = I2C_OK;
+        i2c_stage = STG_ADDR_W;
+        i2c_byte = (u8)(i2c_cur->addr << 1);
+        i2c_state = S_START_A;
+        break;
+    case S_START_A:
+        SDA_OUT();
+        RTC_SDA = 1;
+        i2c_state = S_START_B;
+        break;
+    case S_START_B:
+        SCL_RISE();
+        i2c_state = S_START_C;
+        break;
+    case S_START_C:
+        RTC_SDA = 0;
+        i2c_state = S_START_D;
+        break;
+    case S_START_D:
+        RTC_SCL = 0;
+        i2c_tx(i2c_byte);
+        break;
+    case S_TX_HIGH:
+    case S_ACK_HIGH:
+    case S_RX_HIGH:
+    case S_MACK_HIGH:
+        SCL_RISE();
+        i2c_state++; // matching *_FALL state
+        break;
+    case S_TX_FALL:
+        RTC_SCL = 0;
+        i2c_byte <<= 1;
+        if (--i2c_bits)
+        {
+            RTC_SDA = (i2c_byte & 0x80) ? 1 : 0;
+            i2c_state = S_TX_HIGH;
+        }
+        else
+        {
+            SDA_IN(); // slave drives ACK
+            i2c_state = S_ACK_HIGH;
+        }
+        break;
+    case S_ACK_FALL:
+        if (RTC_SDA)
+        {
+            RTC_SCL = 0;
+            i2c_result = I2C_NACK;
+            i2c_state = S_STOP_A;
+            break;
+        }
+        RTC_SCL = 0;
+        i2c_next();
+        break;
+    case S_RX_FALL:
+        i2c_byte = (i2c_byte << 1) | (RTC_SDA ? 1 : 0);
+        RTC_SCL = 0;
+        if (--i2c_bits)
+        {
+            i2c_state = S_RX_HIGH;
+            break;
+        }
+        x->buf[i2c_idx++] = i2c_byte;
+        SDA_OUT();
+        RTC_SDA = (i2c_idx < x->len) ? 0 : 1; // ACK for more, NACK the last
+        i2c_state = S_MACK_HIGH;
+        break;
+    case S_MACK_FALL:
+        RTC_SCL = 0;
+        if (i2c_idx < x->len)
+        {
+            SDA_IN();
+            i2c_bits = 8;
+            i2c_state = S_RX_HIGH;
+        }
+        else
+            i2c_state = S_STOP_A;
+        break;
+    case S_STOP_A:
+        SDA_OUT();
+        RTC_SDA = 0;
+        i2c_state = S_STOP_B;
+        break;
+    case S_STOP_B:
+        SCL_RISE();
+        i2c_state = S_STOP_C;
+        break;
+    case S_STOP_C:
+        RTC_SDA = 1;
+        i2c_state = S_STOP_D;
+        break;
+    default: // S_STOP_D
+        SDA_IN();
+        i2c_complete();
+        break;
+    }
+}
+
+#endif // I2C_ASYNC
+
+/* ========= Blocking wrappers ================================================== */
+
+static __xdata i2c_xfer_t i2c_blk; // used by I2C_Write() / I2C_Read() only
+
+static u8 i2c_run(u8 addr, u8 reg, u8 *buf, u8 len, u8 read)
+{
+    i2c_blk.addr = addr;
+    i2c_blk.reg = reg;
+    i2c_blk.buf = buf;
+    i2c_blk.len = len;
+    i2c_blk.read = read;
+    while (!I2C_Submit(&i2c_blk))
+        HAL_WAIT_TICK(); // queue full: wait for a slot
+    while (!I2C_Done(&i2c_blk))
+        HAL_WAIT_TICK(); // UART RX keeps running in its ISRs meanwhile
+    return i2c_blk.status;
+}
+
+/**
+ * @brief Write 'len' bytes to register 'reg' of a slave and wait.
+ * @param addr 7-bit slave address
+ * @return I2C_OK, I2C_NACK or I2C_TIMEOUT
+ */
+u8 I2C_Write(u8 addr, u8 reg, const u8 *buf, u8 len)
+{
+    return i2c_run(addr, reg, (u8 *)buf, len, 0);
+}
+
+/**
+ * @brief Read 'len' bytes starting at register 'reg' (repeated START) and wait.
+ * @param addr 7-bit slave address
+ * @return I2C_OK, I2C_NACK or I2C_TIMEOUT
+ */
+u8 I2C_Read(u8 addr, u8 reg, u8 *buf, u8 len)
+{
+    return i2c_run(addr, reg, buf, len, 1);
+}
@@ -0,0 +1,49 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : i2c.c / i2c.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Bit-banged I2C master on RTC_SCL (P3.2) / RTC_SDA (P3.3).
+ *                I2C_ASYNC 1: queued transactions stepped one half bit per
+ *                Timer1 interrupt, so the main loop never waits on the bus.
+ *                I2C_ASYNC 0: blocking transfers with bit timing derived from
+ *                FOSC (100 or 400 kHz) and calibrated against Timer2.
+ *                Both support clock stretching and ACK/NACK/timeout results.
+ * ----------------------------------------------------------------------------- */
+#ifndef __I2C_H__
+#define __I2C_H__
+
+#include "t5l1.h"
+#include "config.h"
+#include "timer.h"
+
+/* Transaction results */
+#define I2C_OK 0      // all bytes acknowledged
+#define I2C_NACK 1    // address or data byte not acknowledged
+#define I2C_TIMEOUT 2 // slave held SCL low longer than I2C_STRETCH_US
+#define I2C_BUSY 0xFF // queued or on the bus
+
+/* One register transaction: START, addr+W, reg, then data out or
+   repeated START, addr+R and 'len' bytes in, STOP */
+typedef struct
+{
+    u8 addr;            // 7-bit slave address
+    u8 reg;             // register / sub-address
+    u8 *buf;            // data to write or read into
+    u8 len;             // data bytes
+    u8 read;            // 1 = read, 0 = write
+    volatile u8 status; // I2C_BUSY, then I2C_OK / I2C_NACK / I2C_TIMEOUT
+} i2c_xfer_t;
+
+#define I2C_Done(x) ((x)->status != I2C_BUSY)
+
+void I2C_Init(void);
+u8 I2C_Submit(__xdata i2c_xfer_t *x);
+u8 I2C_Write(u8 addr, u8 reg, const u8 *buf, u8 len);
+u8 I2C_Read(u8 addr, u8 reg, u8 *buf, u8 len);
+#if I2C_ASYNC
+void I2C_Tick(void); // Timer1_ISR only
+#endif
+
+#endif
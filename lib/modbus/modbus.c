@@ -0,0 +1,300 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : modbus.c / modbus.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Modbus RTU slave and master, see modbus.h.
+ * ----------------------------------------------------------------------------- */
+#define MB_POLL_DEFINE
+#include "modbus.h"
+#include "pool.h"
+#include "uart_flags.h"
+
+__xdata u16 mb_crc_errors = 0;
+
+/* Append the CRC (low byte first) and queue the answer block as it is */
+static void mb_reply(u8 uart, __xdata u8 *resp, u8 len)
+{
+    u16 crc = crc16table(resp, len);
+
+    resp[len++] = (u8)crc;
+    resp[len++] = (u8)(crc >> 8);
+    if (!uart_send_block(uart, resp, len, UART_TX_HIGH))
+        Pool_Free(resp); // queue full: the master times out and retries
+}
+
+/**
+ * @brief Handle one Modbus RTU frame received on a slave port.
+ *
+ * Frames for another slave address are ignored, and so is a frame with a bad
+ * CRC (counted in mb_crc_errors). Broadcast (address 0) writes are applied
+ * without an answer. Written registers raise the uart_flags events as a
+ * DGUS 0x82 write would, and a read as a 0x83 read, so application handlers
+ * do not depend on the protocol of the port.
+ *
+ * @param uart  UART channel number (2, 3, 4, or 5)
+ * @param frame Received frame: address, function code, data, CRC
+ * @param len   Frame length in bytes
+ */
+void Modbus_SlaveFrame(u8 uart, u8 *frame, u16 len)
+{
+    u8 id = frame[0];
+    u8 fc = frame[1];
+    u8 ex = 0;
+    u8 n = 0;
+    u16 reg = 0, qty = 0;
+    __xdata u8 *resp;
+
+    if (len < 4 || len > MB_ADU_MAX || (id != MODBUS_SLAVE_ID && id != 0))
+        return;
+    if (crc16table(frame, len - 2) != ((u16)frame[len - 1] << 8 | frame[len - 2]))
+    {
+        mb_crc_errors++;
+        return;
+    }
+    if (len >= 8)
+    {
+        reg = (u16)frame[2] << 8 | frame[3];
+        qty = (u16)frame[4] << 8 | frame[5]; // FC06: the value
+    }
+
+    switch (fc)
+    {
+    case MB_FC_READ_HOLDING:
+        if (len != 8 || !id)
+            return;
+        if (qty < 1 || qty > 125)
+            ex = MB_EX_VALUE;
+        else if (reg >= MODBUS_REG_COUNT || qty > MODBUS_REG_COUNT - reg)
+            ex = MB_EX_ADDRESS;
+        else
+            Flags_SetByUart(uart, 0x83, MODBUS_VP_BASE + reg, qty);
+        break;
+
+    case MB_FC_WRITE_SINGLE:
+        if (len != 8)
+            return;
+        if (reg >= MODBUS_REG_COUNT)
+            ex = MB_EX_ADDRESS;
+        else
+        {
+            DGUS_WriteBurst(MODBUS_VP_BASE + reg, frame + 4, 1);
+            Flags_SetByUart(uart, 0x82, MODBUS_VP_BASE + reg, qty);
+        }
+        break;
+
+    case MB_FC_WRITE_MULTIPLE:
+        if (len < 9 || len != 9u + frame[6])
+            return;
+        if (qty < 1 || qty > 123 || frame[6] != 2u * qty)
+            ex = MB_EX_VALUE;
+        else if (reg >= MODBUS_REG_COUNT || qty > MODBUS_REG_COUNT - reg)
+            ex = MB_EX_ADDRESS;
+        else
+        {
+            DGUS_WriteBurst(MODBUS_VP_BASE + reg, frame + 7, (u8)qty);
+            for (n = 0; n < (u8)qty; n++)
+                Flags_SetByUart(uart, 0x82, MODBUS_VP_BASE + reg + n,
+                                (u16)frame[7 + 2 * n] << 8 | frame[8 + 2 * n]);
+        }
+        break;
+
+    default:
+        ex = MB_EX_FUNCTION;
+        break;
+    }
+
+    if (!id)
+        return; // broadcast: never answered
+    resp = Pool_Alloc(POOL_OWNER_UART(uart));
+    if (!resp)
+        return; // the master times out and retries
+
+    resp[0] = id;
+    if (ex)
+    {
+        resp[1] = fc | 0x80;
+        resp[2] = ex;
+        n = 3;
+    }
+    else if (fc == MB_FC_READ_HOLDING)
+    {
+        resp[1] = fc;
+        resp[2] = (u8)(2u * qty);
+        DGUS_ReadBytes(MODBUS_VP_BASE + reg, resp + 3, qty); // VPs are big-endian like Modbus
+        n = 3 + resp[2];
+    }
+    else
+    {
+        for (n = 1; n < 6; n++) // FC06 echoes the request, FC16 start + quantity
+            resp[n] = frame[n];
+    }
+    mb_reply(uart, resp, n); // the TX path frees the block once it is sent
+}
+
+#if MB_POLL_COUNT
+
+/* Master bus state */
+#define MB_IDLE 0 // free for the next request
+#define MB_WAIT 1 // request sent, waiting for the answer
+
+typedef struct
+{
+    u8 state; // MB_IDLE / MB_WAIT
+    u8 entry; // poll entry in flight, or the last one sent
+    u8 tries; // sends of that entry so far
+    u16 sent; // sys_tick_ms of the last send
+} mb_bus_t;
+
+__xdata mb_dev_t mb_dev[MB_POLL_DEVICES];
+static __xdata mb_bus_t mb_bus[4];        // index uart - 2
+static __xdata u16 mb_due[MB_POLL_COUNT]; // sys_tick_ms of the next poll, 0 at boot: all due
+static __xdata u8 mb_req[8];
+
+static __code const u8 mb_master_port[4] = {
+    UART2_ENABLE && UART2_PROTO == UART_PROTO_MB_MASTER,
+    UART3_ENABLE && UART3_PROTO == UART_PROTO_MB_MASTER,
+    UART4_ENABLE && UART4_PROTO == UART_PROTO_MB_MASTER,
+    UART5_ENABLE && UART5_PROTO == UART_PROTO_MB_MASTER,
+};
+
+/* Queue the read request of entry e; the TX interrupt sends it and frees the RS485 bus */
+static void mb_send(u8 uart, u8 e, u16 now)
+{
+    __xdata mb_bus_t *b = &mb_bus[uart - 2];
+    u16 crc;
+    u8 i;
+
+    mb_req[0] = MB_Dev_Addr[MB_Poll_Dev[e]];
+    mb_req[1] = MB_Poll_Fc[e];
+    mb_req[2] = (u8)(MB_Poll_Reg[e] >> 8);
+    mb_req[3] = (u8)MB_Poll_Reg[e];
+    mb_req[4] = 0;
+    mb_req[5] = MB_Poll_Qty[e];
+    crc = crc16table(mb_req, 6);
+    mb_req[6] = (u8)crc;
+    mb_req[7] = (u8)(crc >> 8);
+
+    uart_4_5_pin_ctrl(uart, 1);
+    for (i = 0; i < 8; i++)
+        uart_send_byte(uart, mb_req[i]); // 8 bytes always fit the TX ring
+    uart_4_5_release(uart);
+
+    b->entry = e;
+    b->tries++;
+    b->sent = now;
+    b->state = MB_WAIT;
+}
+
+/* Send the next due entry of this port, round robin from the last one */
+static void mb_next(u8 uart, u16 now)
+{
+    __xdata mb_bus_t *b = &mb_bus[uart - 2];
+    __xdata mb_dev_t *d;
+    u8 e = b->entry;
+    u8 k;
+
+    for (k = 0; k < MB_POLL_COUNT; k++)
+    {
+        if (++e >= MB_POLL_COUNT)
+            e = 0;
+        if (MB_Poll_Uart[e] != uart || (s16)(now - mb_due[e]) < 0)
+            continue;
+        d = &mb_dev[MB_Poll_Dev[e]];
+        if (d->offline)
+        {
+            if ((s16)(now - d->probe) < 0)
+                continue;
+            d->probe = now + MB_MASTER_OFFLINE_MS;
+            b->tries = MB_MASTER_RETRIES; // a probe is sent once
+        }
+        else
+            b->tries = 0;
+        mb_due[e] = now + MB_Poll_Period[e];
+        mb_send(uart, e, now);
+        return;
+    }
+}
+
+/**
+ * @brief Modbus master scheduler task (every 1 ms).
+ *
+ * Handles the answer timeout of each master bus: resends up to
+ * MB_MASTER_RETRIES times, then marks the device offline. An idle bus gets
+ * the next due poll entry. Answers are handled in Modbus_MasterFrame(),
+ * which starts the next request at once.
+ */
+void Modbus_MasterTask(void)
+{
+    u16 now = sys_tick_get();
+    u8 uart;
+
+    for (uart = 2; uart <= 5; uart++)
+    {
+        __xdata mb_bus_t *b = &mb_bus[uart - 2];
+
+        if (!mb_master_port[uart - 2])
+            continue;
+        if (b->state == MB_WAIT)
+        {
+            __xdata mb_dev_t *d = &mb_dev[MB_Poll_Dev[b->entry]];
+
+            if ((u16)(now - b->sent) < MB_MASTER_TIMEOUT_MS)
+                continue;
+            d->timeouts++;
+            if (b->tries <= MB_MASTER_RETRIES)
+            {
+                mb_send(uart, b->entry, now);
+                continue;
+            }
+            if (!d->offline)
+            {
+                d->offline = 1;
+                d->probe = now + MB_MASTER_OFFLINE_MS;
+            }
+            b->state = MB_IDLE;
+        }
+        mb_next(uart, now);
+    }
+}
+
+/**
+ * @brief Handle a frame received on a master port.
+ *
+ * Only the answer to the request in flight is taken: same device, a valid
+ * CRC and either the expected register data (stored to the entry's VPs with
+ * one burst) or an exception. Anything else is left to the answer timeout.
+ *
+ * @param uart  UART channel number (2, 3, 4, or 5)
+ * @param frame Received frame: address, function code, data, CRC
+ * @param len   Frame length in bytes
+ */
+void Modbus_MasterFrame(u8 uart, u8 *frame, u16 len)
+{
+    __xdata mb_bus_t *b = &mb_bus[uart - 2];
+    __xdata mb_dev_t *d;
+    u8 e = b->entry;
+
+    if (b->state != MB_WAIT || len < 5 || len > MB_ADU_MAX || frame[0] != MB_Dev_Addr[MB_Poll_Dev[e]])
+        return;
+    if (crc16table(frame, len - 2) != ((u16)frame[len - 1] << 8 | frame[len - 2]))
+    {
+        mb_crc_errors++;
+        return;
+    }
+
+    d = &mb_dev[MB_Poll_Dev[e]];
+    if (frame[1] == MB_Poll_Fc[e] && frame[2] == 2u * MB_Poll_Qty[e] && len == 5u + frame[2])
+    {
+        DGUS_WriteBurst(MB_Poll_Vp[e], frame + 3, MB_Poll_Qty[e]); // big-endian registers, as VPs
+        d->ok++;
+    }
+    else
+        d->errors++; // it answered, so it is still online
+    d->offline = 0;
+    b->state = MB_IDLE;
+    mb_next(uart, sys_tick_get()); // the gap has passed: next request right away
+}
+
+#endif
@@ -0,0 +1,83 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : modbus.c / modbus.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Modbus RTU slave and master.
+ *                Slave (UART_PROTO_MB_SLAVE): holding register r is VP
+ *                MODBUS_VP_BASE + r for r < MODBUS_REG_COUNT; function codes
+ *                03 / 06 / 16 read and write that window with one DGUS burst
+ *                each.
+ *                Master (UART_PROTO_MB_MASTER): polls the generated table
+ *                (src/app/mb_poll.txt -> build/gen/mb_poll_table.h), one
+ *                request in flight per bus, and stores each answer in its
+ *                VPs with one burst. Devices that stop answering are retried,
+ *                then probed every MB_MASTER_OFFLINE_MS.
+ *                Frames are the blocks collected by DGUS_ProcessAllUarts(),
+ *                split on the 3.5-character gap (UART_T_O in uart.h).
+ * ----------------------------------------------------------------------------- */
+#ifndef __MODBUS_H__
+#define __MODBUS_H__
+
+#include "t5l1.h"
+#include "config.h"
+#include "uart.h"
+#include "mb_poll_table.h"
+
+#define MB_ADU_MAX 256 // RTU frame limit: address + PDU (253) + CRC
+
+/* Function codes */
+#define MB_FC_READ_HOLDING 0x03
+#define MB_FC_WRITE_SINGLE 0x06
+#define MB_FC_WRITE_MULTIPLE 0x10
+
+/* Exception codes */
+#define MB_EX_FUNCTION 0x01 // function code not supported
+#define MB_EX_ADDRESS 0x02  // register outside the VP window
+#define MB_EX_VALUE 0x03    // quantity or byte count out of range
+
+#if MODBUS_SLAVE_ID < 1 || MODBUS_SLAVE_ID > 247
+#error "MODBUS_SLAVE_ID must be 1..247"
+#endif
+#if MODBUS_REG_COUNT < 1 || MODBUS_VP_BASE + MODBUS_REG_COUNT > 0x10000UL
+#error "MODBUS_VP_BASE / MODBUS_REG_COUNT window outside the VP space"
+#endif
+#if POOL_BLOCK_SIZE < MB_ADU_MAX
+#error "POOL_BLOCK_SIZE must hold a Modbus RTU frame (256 bytes)"
+#endif
+
+/* Every port in the poll list must be an enabled master port */
+#if MB_POLL_UART2 && !(UART2_ENABLE && UART2_PROTO == UART_PROTO_MB_MASTER)
+#error "src/app/mb_poll.txt polls UART2: set UART2_ENABLE 1 and UART2_PROTO 2"
+#endif
+#if MB_POLL_UART3 && !(UART3_ENABLE && UART3_PROTO == UART_PROTO_MB_MASTER)
+#error "src/app/mb_poll.txt polls UART3: set UART3_ENABLE 1 and UART3_PROTO 2"
+#endif
+#if MB_POLL_UART4 && !(UART4_ENABLE && UART4_PROTO == UART_PROTO_MB_MASTER)
+#error "src/app/mb_poll.txt polls UART4: set UART4_ENABLE 1 and UART4_PROTO 2"
+#endif
+#if MB_POLL_UART5 && !(UART5_ENABLE && UART5_PROTO == UART_PROTO_MB_MASTER)
+#error "src/app/mb_poll.txt polls UART5: set UART5_ENABLE 1 and UART5_PROTO 2"
+#endif
+
+/* Master: per-device link state */
+typedef struct
+{
+    u16 ok;       // answers stored to VPs
+    u16 timeouts; // requests left without an answer (each retry counts)
+    u16 errors;   // exception or malformed answers
+    u8 offline;   // retries used up; only probed until it answers again
+    u16 probe;    // sys_tick_ms of the next probe while offline
+} mb_dev_t;
+
+extern __xdata u16 mb_crc_errors; // frames dropped on a CRC mismatch (slave and master)
+#if MB_POLL_COUNT
+extern __xdata mb_dev_t mb_dev[MB_POLL_DEVICES]; // indexed like MB_Dev_Addr[]
+#endif
+
+void Modbus_SlaveFrame(u8 uart, u8 *frame, u16 len);
+void Modbus_MasterFrame(u8 uart, u8 *frame, u16 len);
+void Modbus_MasterTask(void);
+
+#endif
@@ -0,0 +1,115 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : pool.c / pool.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Fixed-block XRAM pool for frame buffers, see pool.h.
+ * ----------------------------------------------------------------------------- */
+#include "pool.h"
+
+MEM_NOINIT(NOINIT_POOL) u8 pool_mem[POOL_BLOCKS][POOL_BLOCK_SIZE];
+static __xdata u8 pool_owner[POOL_BLOCKS]; // owner per block, POOL_FREE if unused
+static __xdata u8 pool_refs[POOL_BLOCKS];  // Pool_Free() calls left before the block is free
+
+__xdata pool_stat_t pool_stat[POOL_OWNERS];
+__xdata u8 pool_used = 0;
+__xdata u8 pool_hwm = 0;
+
+static __code const u8 pool_quota[POOL_OWNERS] = {
+    POOL_QUOTA_UART, POOL_QUOTA_UART, POOL_QUOTA_UART, POOL_QUOTA_UART,
+    POOL_QUOTA_MON, POOL_QUOTA_APP};
+
+/**
+ * @brief Mark every block free and reset the statistics.
+ *        Called from Sys_Init(), before Uart_Init() takes the RX blocks.
+ */
+void Pool_Init(void)
+{
+    u8 i;
+
+    for (i = 0; i < POOL_BLOCKS; i++)
+        pool_owner[i] = POOL_FREE;
+    for (i = 0; i < POOL_OWNERS; i++)
+    {
+        pool_stat[i].used = 0;
+        pool_stat[i].hwm = 0;
+        pool_stat[i].quota = pool_quota[i];
+        pool_stat[i].fails = 0;
+    }
+    pool_used = 0;
+    pool_hwm = 0;
+}
+
+/**
+ * @brief Take one POOL_BLOCK_SIZE block for an owner.
+ *        The contents are undefined (the pool is not cleared at boot).
+ * @param owner  POOL_OWNER_*
+ * @return The block, or 0 when the owner is at its quota or the pool is empty
+ */
+__xdata u8 *Pool_Alloc(u8 owner)
+{
+    __xdata pool_stat_t *st = &pool_stat[owner];
+    u8 i;
+
+    if (st->used < st->quota)
+    {
+        for (i = 0; i < POOL_BLOCKS; i++)
+        {
+            if (pool_owner[i] != POOL_FREE)
+                continue;
+            pool_owner[i] = owner;
+            pool_refs[i] = 1;
+            if (++st->used > st->hwm)
+                st->hwm = st->used;
+            if (++pool_used > pool_hwm)
+                pool_hwm = pool_used;
+            return pool_mem[i];
+        }
+    }
+    st->fails++;
+    return 0;
+}
+
+/**
+ * @brief Add a reference to a block, for one more user that will call
+ *        Pool_Free() on it (the same upload queued on several ports).
+ *        Null and foreign pointers are ignored.
+ */
+void Pool_Hold(__xdata u8 *blk)
+{
+    __xdata u8 *p = pool_mem[0];
+    u8 i;
+
+    for (i = 0; i < POOL_BLOCKS; i++, p += POOL_BLOCK_SIZE)
+    {
+        if (p == blk && pool_owner[i] != POOL_FREE)
+        {
+            pool_refs[i]++;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Return a block taken with Pool_Alloc(). A block with references
+ *        from Pool_Hold() is freed by the last call. Null and foreign
+ *        pointers are ignored.
+ */
+void Pool_Free(__xdata u8 *blk)
+{
+    __xdata u8 *p = pool_mem[0];
+    u8 i;
+
+    for (i = 0; i < POOL_BLOCKS; i++, p += POOL_BLOCK_SIZE)
+    {
+        if (p != blk || pool_owner[i] == POOL_FREE)
+            continue;
+        if (--pool_refs[i])
+            return;
+        pool_stat[pool_owner[i]].used--;
+        pool_owner[i] = POOL_FREE;
+        pool_used--;
+        return;
+    }
+}
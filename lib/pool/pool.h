@@ -0,0 +1,60 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : pool.c / pool.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Fixed-block XRAM pool for frame buffers.
+ *                POOL_BLOCKS blocks of POOL_BLOCK_SIZE bytes in the NOINIT
+ *                area, shared by the UART RX buffers, the 0x83 answer and
+ *                the monitor upload. Every owner has a quota; in-use count,
+ *                high-water mark and refused requests are kept per owner.
+ *                A block queued on several ports (Pool_Hold) is free after
+ *                the last Pool_Free().
+ *                Main context only: ISRs use blocks handed to them, they
+ *                never allocate.
+ * ----------------------------------------------------------------------------- */
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#include "t5l1.h"
+#include "config.h"
+#include "mem.h"
+
+/* Owners */
+#define POOL_OWNER_UART(n) ((n) - 2) // UART2..5 -> 0..3: RX blocks and their answers
+#define POOL_OWNER_MON 4             // DGUS monitor upload
+#define POOL_OWNER_APP 5             // application, logging
+#define POOL_OWNERS 6
+
+#define POOL_FREE 0xFF // pool_owner[] of an unused block
+
+#if POOL_BLOCK_SIZE < 258
+#error "POOL_BLOCK_SIZE must hold the largest DGUS frame (258 bytes)"
+#endif
+#if POOL_BLOCKS > 32
+#error "POOL_BLOCKS must be 32 or less"
+#endif
+/* RX ring + frame being collected per enabled UART, plus an answer and the monitor packet */
+#if POOL_BLOCKS < 2 * (UART2_ENABLE + UART3_ENABLE + UART4_ENABLE + UART5_ENABLE) + 2
+#error "POOL_BLOCKS too small for the enabled UARTs"
+#endif
+
+typedef struct
+{
+    u8 used;   // blocks held now
+    u8 hwm;    // most blocks held at once
+    u8 quota;  // POOL_QUOTA_*
+    u16 fails; // requests refused (quota or pool exhausted)
+} pool_stat_t;
+
+extern __xdata pool_stat_t pool_stat[POOL_OWNERS];
+extern __xdata u8 pool_used; // blocks in use, all owners
+extern __xdata u8 pool_hwm;  // high-water mark of pool_used
+
+void Pool_Init(void);
+__xdata u8 *Pool_Alloc(u8 owner);
+void Pool_Hold(__xdata u8 *blk);
+void Pool_Free(__xdata u8 *blk);
+
+#endif
@@ -0,0 +1,196 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : prof.c / prof.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Hot-path cycle profiling (PROFILE_ENABLE in config.h).
+ *                Timer0 runs free at FOSC/12 with an overflow counter, giving
+ *                a 32-bit cycle clock (1 count = 12 CPU clocks, ~58 ns).
+ *                Tagged sections record count/total/min/max; results go to a
+ *                reserved VP block and to a UART dump command.
+ * ----------------------------------------------------------------------------- */
+#include "prof.h"
+
+#if PROFILE_ENABLE
+
+#include "sys.h"
+#include "uart.h"
+#include "crc16.h"
+
+__xdata prof_stat_t prof_stats[PROF_TAG_COUNT];
+volatile __data u16 prof_t0_hi = 0;
+
+#define PROF_STAT_BYTES 14 // count(2) total(4) min(4) max(4), big-endian
+
+/**
+ * @brief Start Timer0 as the free-running profiling clock and clear stats.
+ *
+ * Timer0 is not used elsewhere while PROFILE_ENABLE is set: it runs in
+ * mode 1 without reload and Timer0_ISR only counts overflows.
+ */
+void Prof_Init(void)
+{
+    Prof_Reset();
+    TMOD &= 0xF0; // clear lower nibble
+    TMOD |= 0x01; // Timer0 mode 1 (16-bit), free-running
+    TH0 = 0x00;
+    TL0 = 0x00;
+    ET0 = 1; // overflow extends the count
+    TR0 = 1;
+}
+
+/**
+ * @brief Clear all counters (min starts at the maximum so any run lowers it).
+ */
+void Prof_Reset(void)
+{
+    __bit ea = EA;
+
+    for (u8 i = 0; i < PROF_TAG_COUNT; i++)
+    {
+        EA = 0;
+        prof_stats[i].count = 0;
+        prof_stats[i].total = 0;
+        prof_stats[i].min = 0xFFFFFFFFUL;
+        prof_stats[i].max = 0;
+        EA = ea;
+    }
+}
+
+/**
+ * @brief 32-bit Timer0 count (main context only).
+ *
+ * TH0/TL0 are read high-low-high; a pending TF0 (overflow not yet serviced
+ * because EA is off) adds the missing upper increment.
+ */
+u32 prof_now(void)
+{
+    u16 hi;
+    u8 th, tl;
+    __bit ea = EA;
+
+    EA = 0;
+    PROF_T0_READ(th, tl);
+    hi = prof_t0_hi;
+    if (TF0)
+    {
+        PROF_T0_READ(th, tl);
+        hi++;
+    }
+    EA = ea;
+
+    return ((u32)hi << 16) | ((u16)th << 8) | tl;
+}
+
+/**
+ * @brief Add one run of a main-context section to its tag.
+ * @param tag    PROF_* section
+ * @param counts Duration in Timer0 counts
+ */
+void prof_record(u8 tag, u32 counts)
+{
+    __xdata prof_stat_t *s = &prof_stats[tag];
+
+    s->count++;
+    s->total += counts;
+    if (counts < s->min)
+        s->min = counts;
+    if (counts > s->max)
+        s->max = counts;
+}
+
+/* Consistent copy of one tag (ISR tags update asynchronously) */
+static void prof_snapshot(u8 tag, __xdata prof_stat_t *dst)
+{
+    __bit ea = EA;
+
+    EA = 0;
+    *dst = prof_stats[tag];
+    EA = ea;
+}
+
+/**
+ * @brief Mirror all stats to the VP block at PROF_VP_BASE.
+ *
+ * Per tag, PROF_VP_WORDS words: count, total hi/lo, min hi/lo, max hi/lo.
+ * A tag that never ran reports min = 0. Runs as a scheduler task; its own
+ * DGUS_Write_VP calls show up in the PROF_DGUS_WRITE tag.
+ */
+void Prof_Export(void)
+{
+    static __xdata prof_stat_t s;
+    u16 vp = PROF_VP_BASE;
+
+    for (u8 i = 0; i < PROF_TAG_COUNT; i++)
+    {
+        prof_snapshot(i, &s);
+        if (!s.count)
+            s.min = 0;
+        DGUS_Write_VP(vp++, s.count);
+        DGUS_Write_VP(vp++, (u16)(s.total >> 16));
+        DGUS_Write_VP(vp++, (u16)s.total);
+        DGUS_Write_VP(vp++, (u16)(s.min >> 16));
+        DGUS_Write_VP(vp++, (u16)s.min);
+        DGUS_Write_VP(vp++, (u16)(s.max >> 16));
+        DGUS_Write_VP(vp++, (u16)s.max);
+    }
+}
+
+static void prof_put32(__xdata u8 *p, u32 v)
+{
+    p[0] = (u8)(v >> 24);
+    p[1] = (u8)(v >> 16);
+    p[2] = (u8)(v >> 8);
+    p[3] = (u8)v;
+}
+
+/**
+ * @brief Send all stats as one frame on a UART (reply to PROF_CMD dump).
+ *
+ * Frame: [5A A5 | LEN | PROF_CMD | N | N x (count(2) total(4) min(4) max(4)) | (CRC Lo | CRC Hi)]
+ * All fields big-endian, units are Timer0 counts (12 CPU clocks each).
+ *
+ * @param uart   UART channel number (2..5)
+ * @param crc_on Append CRC-16/MODBUS like the other replies on this port
+ */
+void Prof_Dump(u8 uart, __bit crc_on)
+{
+    static __xdata u8 out[5 + PROF_TAG_COUNT * PROF_STAT_BYTES + 2];
+    static __xdata prof_stat_t s;
+    __xdata u8 *p = &out[5];
+    u8 n;
+
+    for (u8 i = 0; i < PROF_TAG_COUNT; i++)
+    {
+        prof_snapshot(i, &s);
+        if (!s.count)
+            s.min = 0;
+        p[0] = (u8)(s.count >> 8);
+        p[1] = (u8)s.count;
+        prof_put32(p + 2, s.total);
+        prof_put32(p + 6, s.min);
+        prof_put32(p + 10, s.max);
+        p += PROF_STAT_BYTES;
+    }
+
+    n = 5 + PROF_TAG_COUNT * PROF_STAT_BYTES;
+    out[0] = DTHD1;
+    out[1] = DTHD2;
+    out[2] = (u8)(n - 3);
+    out[3] = PROF_CMD;
+    out[4] = PROF_TAG_COUNT;
+    if (crc_on)
+    {
+        u16 crc;
+
+        out[2] += 2;
+        crc = crc16table(out + 3, (u16)(n - 3));
+        out[n++] = (u8)(crc & 0xFF);
+        out[n++] = (u8)(crc >> 8);
+    }
+
+    uart_send_frame(uart, out, n);
+}
+
+#endif // PROFILE_ENABLE
@@ -0,0 +1,109 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : prof.c / prof.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Hot-path cycle profiling (PROFILE_ENABLE in config.h).
+ *                Timer0 runs free at FOSC/12 with an overflow counter, giving
+ *                a 32-bit cycle clock (1 count = 12 CPU clocks, ~58 ns).
+ *                Tagged sections record count/total/min/max; results go to a
+ *                reserved VP block and to a UART dump command.
+ * ----------------------------------------------------------------------------- */
+#ifndef __PROF_H__
+#define __PROF_H__
+
+#include "t5l1.h"
+#include "config.h"
+
+/* Profiled sections */
+enum
+{
+    PROF_DGUS_READ = 0, // DGUS_Read_VP
+    PROF_DGUS_WRITE,    // DGUS_Write_VP
+    PROF_CRC16,         // crc16table
+    PROF_PARSE,         // DGUS_ParseUartFrame
+    PROF_ISR_UART2,     // uart2_ISR
+    PROF_ISR_UART3,     // uart3_ISR
+    PROF_ISR_UART4_RX,  // uart4_RISR
+    PROF_ISR_UART4_TX,  // uart4_TISR
+    PROF_ISR_UART5_RX,  // uart5_RISR
+    PROF_ISR_UART5_TX,  // uart5_TISR
+    PROF_ISR_TIMER2,    // Timer2_ISR
+    PROF_TAG_COUNT
+};
+
+/* Words per tag in the VP block: count, total(2), min(2), max(2) */
+#define PROF_VP_WORDS 7
+
+#if PROFILE_ENABLE
+
+typedef struct
+{
+    u16 count; // completed runs (wraps)
+    u32 total; // Timer0 counts, sum of all runs
+    u32 min;   // shortest run
+    u32 max;   // longest run
+} prof_stat_t;
+
+extern __xdata prof_stat_t prof_stats[PROF_TAG_COUNT];
+extern volatile __data u16 prof_t0_hi; // Timer0 overflows (upper 16 bits)
+
+void Prof_Init(void);
+void Prof_Reset(void);
+u32 prof_now(void);
+void prof_record(u8 tag, u32 counts);
+void Prof_Export(void);
+void Prof_Dump(u8 uart, __bit crc_on);
+
+/* Main-context sections: one BEGIN/END pair per function scope */
+#define PROF_BEGIN(tag) u32 prof_start_ = prof_now()
+#define PROF_END(tag) prof_record((tag), prof_now() - prof_start_)
+
+/*
+ * ISR sections: fully inline (no shared non-reentrant helpers), 16-bit
+ * Timer0 delta, which covers ISRs up to ~3.8 ms. TH0 is read twice to
+ * catch a carry out of TL0.
+ */
+#define PROF_T0_READ(th, tl) \
+    do                       \
+    {                        \
+        th = TH0;            \
+        tl = TL0;            \
+        if (TH0 != th)       \
+        {                    \
+            th = TH0;        \
+            tl = TL0;        \
+        }                    \
+    } while (0)
+
+#define PROF_ISR_BEGIN(tag) \
+    u8 prof_th_, prof_tl_;  \
+    u16 prof_isr_start_;    \
+    PROF_T0_READ(prof_th_, prof_tl_); \
+    prof_isr_start_ = ((u16)prof_th_ << 8) | prof_tl_
+
+#define PROF_ISR_END(tag)                                                       \
+    do                                                                          \
+    {                                                                           \
+        u16 prof_d_;                                                            \
+        PROF_T0_READ(prof_th_, prof_tl_);                                       \
+        prof_d_ = (u16)((((u16)prof_th_ << 8) | prof_tl_) - prof_isr_start_);   \
+        prof_stats[tag].count++;                                                \
+        prof_stats[tag].total += prof_d_;                                       \
+        if (prof_d_ < prof_stats[tag].min)                                      \
+            prof_stats[tag].min = prof_d_;                                      \
+        if (prof_d_ > prof_stats[tag].max)                                      \
+            prof_stats[tag].max = prof_d_;                                      \
+    } while (0)
+
+#else
+
+#define PROF_BEGIN(tag)
+#define PROF_END(tag)
+#define PROF_ISR_BEGIN(tag)
+#define PROF_ISR_END(tag)
+
+#endif // PROFILE_ENABLE
+
+#endif
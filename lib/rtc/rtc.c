@@ -6,159 +6,99 @@
  *  Contact : recepsenbas@gmail.com
  *  Description :
  *    Clean-room reimplementation of the DWIN T5L real-time clock interface.
- *    Fully rewritten for SDCC / 8051 architecture with safe I2C bit-banging
- *    and DGUS variable synchronization.
+ *    Fully rewritten for SDCC / 8051 architecture on the I2C master in
+ *    lib/i2c (time reads are queued, not waited on), with DGUS variable
+ *    synchronization.
  *
  *    Supports RX8130 and SD2058 RTC chips with legacy timing compatibility.
  *    Preserves functional behavior for DGUS panels without using any DWIN SDK code.
  * ----------------------------------------------------------------------------- */
 
 #include "rtc.h"
+#include "i2c.h"
+#include "clock.h"
 
 /* ========= Local configuration ================================================= */
 
-/* RX8130 / SD2058 I2C addresses (7-bit: 0x32/0x32 -> 8-bit RW: 0x64 / 0x65) */
-#define RTC_I2C_ADDR_W 0x64
-#define RTC_I2C_ADDR_R 0x65
+/* RX8130 / SD2058 I2C address (7-bit 0x32 -> 8-bit RW: 0x64 / 0x65) */
+#define RTC_I2C_ADDR 0x32
 
-/* Busy-wait "us" delay tuned for SDCC on T5L1.
-   NOTE: These are crude cycle burns; do not change counts unless measured. */
-static void rtc_delay_ticks(uint8_t n)
-{
-	u8 i;
-	for (i = 0; i < n; i++)
-		;
-}
+/* DGUS time VPs: Year/Month, Day/Week, Hour/Minute, Second/Reserved */
+#define RTC_VP 0x0010
 
-/* Legacy names kept (DWIN originals) */
-static void Delayus(void) { rtc_delay_ticks(80); } /* ~50us (as original comment) */
-static void delayus(uint8_t t)
-{
-	while (t--)
-		rtc_delay_ticks(50);
-}
+/* RTC_PERIOD_MS periods between hardware reads */
+#define RTC_RESYNC_PERIODS ((u16)(RTC_RESYNC_MIN * 60000UL / RTC_PERIOD_MS))
 
 /* ========= Driver state ======================================================== */
 
 __bit RTC_Flog = 0;						/* one-shot init flag */
-static u8 Select_rtc = SELECT_RTC_TYPE; /* runtime selected RTC type */
-static u8 __xdata Rtcdata[8] = {0};		/* temporary time buffer */
-
-/* ========= Low-level GPIO/I2C helpers (legacy API preserved) =================== */
-
-/* Switch SDA pin direction by toggling P3MDOUT bit. Implementation relies on
- * T5L1H.h to provide P3MDOUT, RTC_SDA, RTC_SCL symbols. */
-void SDA_IN(void) { RTC_DIR_REG &= ~0x08; } /* P3.3 input (open drain)  */
-void SDA_OUT(void) { RTC_DIR_REG |= 0x08; } /* P3.3 output (push/pull)  */
-
-/* START condition: SDA 1->0 while SCL high */
-void RTC_I2C_Start(void)
-{
-	SDA_OUT();
-	RTC_SDA = 1;
-	RTC_SCL = 1;
-	Delayus();
-	RTC_SDA = 0;
-	Delayus();
-	RTC_SCL = 0;
-	Delayus();
-}
 
-/* STOP condition: SDA 0->1 while SCL high */
-void RTC_I2C_Stop(void)
+#if SELECT_RTC_TYPE /* no chip: RTC_Service() is empty, nothing below is used */
+static u8 Select_rtc = SELECT_RTC_TYPE; /* runtime selected RTC type */
+static u8 __xdata Rtcdata[7] = {0};		/* decoded time Y, M, D, W, H, M, S */
+static __xdata clock_dt_t rtc_dt;		/* decoded chip time for Clock_Sync() */
+static __xdata u16 rtc_vp[4];			/* last words written to RTC_VP.. */
+static __bit rtc_vp_valid = 0;			/* rtc_vp[] holds what the panel shows */
+
+/* Register write helpers (lib/i2c); results are ignored like before */
+static void rtc_write(u8 reg, const u8 *buf, u8 len) { (void)I2C_Write(RTC_I2C_ADDR, reg, buf, len); }
+static void rtc_write1(u8 reg, u8 val) { rtc_write(reg, &val, 1); }
+static void rtc_write2(u8 reg, u8 v0, u8 v1)
 {
-	SDA_OUT();
-	RTC_SDA = 0;
-	RTC_SCL = 1;
-	Delayus();
-	RTC_SDA = 1;
-	Delayus();
-	SDA_IN();
+	u8 b[2];
+	b[0] = v0;
+	b[1] = v1;
+	rtc_write(reg, b, 2);
 }
 
-/* Master ACK (drive SDA low during SCL pulse) */
-void RTC_I2C_Mack(void)
-{
-	SDA_OUT();
-	RTC_SDA = 0;
-	Delayus();
-	RTC_SCL = 1;
-	Delayus();
-	RTC_SCL = 0;
-	Delayus();
-}
+/* Background time read (lib/i2c queue); RTC_Service() polls for completion */
+static __xdata i2c_xfer_t rtc_xfer;
+static __xdata u8 rtc_raw[7];
+static __xdata u16 rtc_last;	 /* sys tick of the last RTC_PERIOD_MS step */
+static __xdata u16 rtc_periods; /* RTC_PERIOD_MS steps since the last read */
+static __bit rtc_busy = 0;		 /* rtc_xfer queued or on the bus */
 
-/* Master NACK (drive SDA high during SCL pulse) */
-void RTC_I2C_Mnak(void)
+/* Queue a read of the 7 time registers (sec..year) starting at 'reg' */
+static void rtc_read_start(u8 reg)
 {
-	SDA_OUT();
-	RTC_SDA = 1;
-	Delayus();
-	RTC_SCL = 1;
-	Delayus();
-	RTC_SCL = 0;
-	Delayus();
+	rtc_xfer.addr = RTC_I2C_ADDR;
+	rtc_xfer.reg = reg;
+	rtc_xfer.buf = rtc_raw;
+	rtc_xfer.len = 7;
+	rtc_xfer.read = 1;
+	rtc_busy = I2C_Submit(&rtc_xfer); /* queue full: retry next period */
 }
 
-/* Wait for slave ACK after a written byte (sample SDA low while SCL high) */
-void RTC_I2C_Cack(void)
+/* Copy the completed read into Rtcdata[6..0]; 0 if the chip did not answer */
+static u8 rtc_read_time(void)
 {
 	u8 i;
-	SDA_IN();
-	RTC_SDA = 1;
-	Delayus();
-	RTC_SCL = 1;
-	Delayus();
-	for (i = 0; i < 50; i++)
-	{ /* timeout guard to avoid deadlock */
-		if (!RTC_SDA)
-			break; /* ACK observed */
-		Delayus();
-	}
-	RTC_SCL = 0;
-	Delayus();
-	SDA_OUT();
-}
 
-/* Write one byte on I2C (MSB first) */
-static void i2c_write_byte(u8 dat)
-{
-	u8 i;
-	SDA_OUT();
-	for (i = 0; i < 8; i++)
-	{
-		RTC_SDA = (dat & 0x80) ? 1 : 0;
-		dat <<= 1;
-		Delayus();
-		RTC_SCL = 1;
-		Delayus();
-		RTC_SCL = 0;
-		Delayus();
-	}
-	RTC_I2C_Cack();
+	if (rtc_xfer.status != I2C_OK)
+		return 0;
+	for (i = 0; i < 7; i++)
+		Rtcdata[6 - i] = rtc_raw[i];
+	return 1;
 }
 
-/* Read one byte on I2C (MSB first) */
-static u8 i2c_read_byte(void)
+/* Set the software clock from decimal Rtcdata[0..6] (Y, M, D, W, H, M, S) */
+static void rtc_sync_clock(u8 step)
 {
-	u8 i, dat = 0;
-	SDA_IN();
-	for (i = 0; i < 8; i++)
-	{
-		Delayus();
-		RTC_SCL = 1;
-		Delayus();
-		dat <<= 1;
-		if (RTC_SDA)
-			dat |= 0x01;
-		RTC_SCL = 0;
-		Delayus();
-	}
-	return dat;
+	rtc_dt.year = Rtcdata[0];
+	rtc_dt.month = Rtcdata[1];
+	rtc_dt.day = Rtcdata[2];
+	rtc_dt.week = Rtcdata[3];
+	rtc_dt.hour = Rtcdata[4];
+	rtc_dt.min = Rtcdata[5];
+	rtc_dt.sec = Rtcdata[6];
+	Clock_Sync(&rtc_dt, step);
 }
 
 /* ========= RX8130 backend ====================================================== */
 
+/* 0x1C..0x1F control block written before every time update */
+static __code const u8 rx8130_ctrl[4] = {0x48, 0x00, 0x40, 0x10};
+
 /**
  * @brief Compute weekday (0..6) for given date (year as 0..99 → 2000+year).
  *        Matches original algorithm; kept for behavioral compatibility.
@@ -186,28 +126,15 @@ static u8 RTC_Get_Week(u8 years, u8 month, u8 day)
 }
 
 /**
- * @brief Read current time from RX8130 and mirror to DGUS VPs 0x0010..0x0013.
- *        Call periodically (handled by RTC_Service()).
+ * @brief Decode a completed RX8130 time read (registers 0x10..0x16) and set
+ *        the software clock from it. Called by RTC_Service().
  */
 static void RTC_ReadAndSync(void)
 {
 	u8 i, N, M;
 
-	RTC_I2C_Start();
-	i2c_write_byte(RTC_I2C_ADDR_W);
-	i2c_write_byte(0x10); /* register base */
-	RTC_I2C_Stop();
-
-	RTC_I2C_Start();
-	i2c_write_byte(RTC_I2C_ADDR_R);
-	for (i = 6; i > 0; i--)
-	{
-		Rtcdata[i] = i2c_read_byte();
-		RTC_I2C_Mack();
-	}
-	Rtcdata[0] = i2c_read_byte();
-	RTC_I2C_Mnak();
-	RTC_I2C_Stop();
+	if (!rtc_read_time())
+		return;
 
 	/* BCD to decimal */
 	for (i = 0; i < 3; i++)
@@ -224,12 +151,7 @@ static void RTC_ReadAndSync(void)
 	}
 
 	Rtcdata[3] = RTC_Get_Week(Rtcdata[0], Rtcdata[1], Rtcdata[2]);
-
-	/* Mirror to DGUS variable VPs (Year/Month, Day/Week, Hour/Minute, Second/Reserved) */
-	DGUS_Write_VP(0x0010, (Rtcdata[0] << 8) + Rtcdata[1]);
-	DGUS_Write_VP(0x0011, (Rtcdata[2] << 8) + Rtcdata[3]);
-	DGUS_Write_VP(0x0012, (Rtcdata[4] << 8) + Rtcdata[5]);
-	DGUS_Write_VP(0x0013, (Rtcdata[6] << 8) + Rtcdata[7]);
+	rtc_sync_clock(0);
 }
 
 /**
@@ -237,57 +159,19 @@ static void RTC_ReadAndSync(void)
  */
 static void RTC_InitDefault(void)
 {
-	u8 i;
-
-	RTC_I2C_Start();
-	i2c_write_byte(RTC_I2C_ADDR_W);
-	i2c_write_byte(0x1D);
-	RTC_I2C_Stop();
+	static __code const u8 deftime[7] = {0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x17}; /* sec..year */
+	u8 st[2];
 
-	RTC_I2C_Start();
-	i2c_write_byte(RTC_I2C_ADDR_R);
-	i = i2c_read_byte(); /* 0x1D content */
-	RTC_I2C_Mack();
-	(void)i2c_read_byte(); /* dummy */
-	RTC_I2C_Mnak();
-	RTC_I2C_Stop();
+	if (I2C_Read(RTC_I2C_ADDR, 0x1D, st, 2) != I2C_OK) /* 0x1D content + dummy */
+		return;
 
-	if ((i & 0x02) == 0x02)
+	if ((st[0] & 0x02) == 0x02)
 	{
 		/* Reconfigure default time */
-		RTC_I2C_Start(); /* 30 = 00 */
-		i2c_write_byte(RTC_I2C_ADDR_W);
-		i2c_write_byte(0x30);
-		i2c_write_byte(0x00);
-		RTC_I2C_Stop();
-
-		RTC_I2C_Start(); /* 1C-1F = 48 00 40 10 */
-		i2c_write_byte(RTC_I2C_ADDR_W);
-		i2c_write_byte(0x1C);
-		i2c_write_byte(0x48);
-		i2c_write_byte(0x00);
-		i2c_write_byte(0x40);
-		i2c_write_byte(0x10);
-		RTC_I2C_Stop();
-
-		RTC_I2C_Start(); /* 10-16 = default BCD time */
-		i2c_write_byte(RTC_I2C_ADDR_W);
-		i2c_write_byte(0x10);
-		i2c_write_byte(0x00); /* sec */
-		i2c_write_byte(0x00); /* min */
-		i2c_write_byte(0x00); /* hour */
-		i2c_write_byte(0x01); /* week */
-		i2c_write_byte(0x01); /* day  */
-		i2c_write_byte(0x01); /* mon  */
-		i2c_write_byte(0x17); /* year */
-		RTC_I2C_Stop();
-
-		RTC_I2C_Start(); /* 1E-1F 00 10 */
-		i2c_write_byte(RTC_I2C_ADDR_W);
-		i2c_write_byte(0x1E);
-		i2c_write_byte(0x00);
-		i2c_write_byte(0x10);
-		RTC_I2C_Stop();
+		rtc_write1(0x30, 0x00);					 /* 30 = 00 */
+		rtc_write(0x1C, (const u8 *)rx8130_ctrl, 4); /* 1C-1F = 48 00 40 10 */
+		rtc_write(0x10, (const u8 *)deftime, 7);	 /* 10-16 = default BCD time */
+		rtc_write2(0x1E, 0x00, 0x10);				 /* 1E-1F 00 10 */
 	}
 }
 
@@ -300,161 +184,76 @@ static void RTC_Set_Time(void)
 	u16 V1 = DGUS_Read_VP(0x009C); /* 0x5AA5 */
 	if (V1 == 0x5AA5)
 	{
-		u8 N;
-		u8 TimeS[7]; /* Y, M, D, W, H, M, S in BCD */
-		__bit Flog = 1;
+		u8 i;
+		u8 Dec[7];	 /* Y, M, D, W, H, M, S decimal */
+		u8 Regs[7]; /* 0x10..0x16: S, M, H, W, D, M, Y in BCD */
 
 		V1 = DGUS_Read_VP(0x009D); /* Year, Month */
-		N = (u8)(V1 >> 8);
-		TimeS[0] = ((N / 10) * 16) + (N % 10);
-		N = (u8)(V1);
-		TimeS[1] = ((N / 10) * 16) + (N % 10);
-
+		Dec[0] = (u8)(V1 >> 8);
+		Dec[1] = (u8)(V1);
 		V1 = DGUS_Read_VP(0x009E); /* Day, Hour   */
-		N = (u8)(V1 >> 8);
-		TimeS[2] = ((N / 10) * 16) + (N % 10);
-		N = (u8)(V1);
-		TimeS[4] = ((N / 10) * 16) + (N % 10);
-
+		Dec[2] = (u8)(V1 >> 8);
+		Dec[4] = (u8)(V1);
 		V1 = DGUS_Read_VP(0x009F); /* Minute, Sec */
-		N = (u8)(V1 >> 8);
-		TimeS[5] = ((N / 10) * 16) + (N % 10);
-		N = (u8)(V1);
-		TimeS[6] = ((N / 10) * 16) + (N % 10);
+		Dec[5] = (u8)(V1 >> 8);
+		Dec[6] = (u8)(V1);
 
 		DGUS_Write_VP(0x009C, 0); /* clear trigger */
-
-		while (Flog)
-		{
-			/* Unlock & write sequence (mirrors original) */
-			RTC_I2C_Start();
-			i2c_write_byte(RTC_I2C_ADDR_W);
-			i2c_write_byte(0x30);
-			i2c_write_byte(0x00);
-			RTC_I2C_Stop();
-
-			RTC_I2C_Start();
-			i2c_write_byte(RTC_I2C_ADDR_W);
-			i2c_write_byte(0x1C);
-			i2c_write_byte(0x48);
-			i2c_write_byte(0x00);
-			i2c_write_byte(0x40);
-			i2c_write_byte(0x10);
-			RTC_I2C_Stop();
-
-			RTC_I2C_Start(); /* 10-16: set BCD time */
-			i2c_write_byte(RTC_I2C_ADDR_W);
-			i2c_write_byte(0x10);
-			i2c_write_byte(TimeS[6]); /* sec  */
-			i2c_write_byte(TimeS[5]); /* min  */
-			i2c_write_byte(TimeS[4]); /* hour */
-			i2c_write_byte(TimeS[3]); /* week */
-			i2c_write_byte(TimeS[2]); /* day  */
-			i2c_write_byte(TimeS[1]); /* mon  */
-			i2c_write_byte(TimeS[0]); /* year */
-			RTC_I2C_Stop();
-
-			RTC_I2C_Start(); /* 1E-1F: confirm */
-			i2c_write_byte(RTC_I2C_ADDR_W);
-			i2c_write_byte(0x1E);
-			i2c_write_byte(0x00);
-			i2c_write_byte(0x10);
-			RTC_I2C_Stop();
-
-			Flog = 0;
-		}
+		Dec[3] = RTC_Get_Week(Dec[0], Dec[1], Dec[2]);
+
+		for (i = 0; i < 7; i++)
+			Regs[6 - i] = ((Dec[i] / 10) * 16) + (Dec[i] % 10);
+		/* RX8130 week register is one-hot, bit 0 = Sunday */
+		Regs[3] = (u8)(1 << Dec[3]);
+
+		/* Unlock & write sequence (mirrors original) */
+		rtc_write1(0x30, 0x00);
+		rtc_write(0x1C, (const u8 *)rx8130_ctrl, 4);
+		rtc_write(0x10, Regs, 7);	  /* 10-16: set BCD time */
+		rtc_write2(0x1E, 0x00, 0x10); /* 1E-1F: confirm */
+
+		for (i = 0; i < 7; i++)
+			Rtcdata[i] = Dec[i];
+		rtc_sync_clock(1); /* show the new time without waiting for a resync */
 	}
 }
 
 /* ========= SD2058 backend (kept functionally identical) ======================= */
 
-/* Simple helpers kept for compatibility with original names */
-static void i2cstart(void) { RTC_I2C_Start(); }
-static void i2cstop(void) { RTC_I2C_Stop(); }
-static void mack(void) { RTC_I2C_Mack(); }
-static void mnak(void) { RTC_I2C_Mnak(); }
-static void cack(void) { RTC_I2C_Cack(); }
-static void i2cbw(u8 d) { i2c_write_byte(d); }
-static u8 i2cbr(void) { return i2c_read_byte(); }
+/* Write-protect control: WRTC1 = 0x10 bit 7, WRTC2/WRTC3 = 0x0F bits 2/7 */
+static void sd2058_write_enable(u8 ctr2, u8 ctr3)
+{
+	rtc_write1(0x10, ctr3 | 0x80);
+	rtc_write1(0x0F, ctr2 | 0x84);
+}
+
+static void sd2058_write_disable(u8 ctr2, u8 ctr3)
+{
+	rtc_write1(0x10, ctr3 & (u8)~0x80);
+	rtc_write1(0x0F, ctr2 & (u8)~0x84);
+}
 
 /* Check whether SD2058 has lost power; if so, initialize with default time. */
 static void RTC_InitDefault_1(void)
 {
-	u8 dat1, dat2;
-
-	/* Read status at 0x0F.. */
-	i2cstart();
-	i2cbw(RTC_I2C_ADDR_W);
-	i2cbw(0x0F);
-	i2cstart();
-	i2cbw(RTC_I2C_ADDR_R);
-	dat2 = i2cbr();
-	mack();
-	dat1 = i2cbr();
-	mnak();
-	i2cstop();
-
-	if (dat2 & 0x01)
-	{
-		if (dat2 & 0x84)
-		{ /* clear WRTC2/WRTC3 if set */
-			dat2 &= (u8)~0x84;
-			i2cstart();
-			i2cbw(RTC_I2C_ADDR_W);
-			i2cbw(0x0F);
-			i2cbw(dat2);
-			i2cstop();
-		}
-		if (dat1 & 0x80)
-		{ /* clear WRTC1 if set */
-			dat1 &= (u8)~0x80;
-			i2cstart();
-			i2cbw(RTC_I2C_ADDR_W);
-			i2cbw(0x10);
-			i2cbw(dat1);
-			i2cstop();
-		}
+	/* Default time 2021-01-01 Friday 00:00:00, 24h mode (sec..year) */
+	static __code const u8 deftime[7] = {0x00, 0x00, 0x80, 0x05, 0x01, 0x01, 0x21};
+	u8 st[2]; /* 0x0F (CTR2), 0x10 (CTR3) */
 
-		/* write enable */
-		dat1 |= 0x80;
-		i2cstart();
-		i2cbw(RTC_I2C_ADDR_W);
-		i2cbw(0x10);
-		i2cbw(dat1);
-		i2cstop();
-		dat2 |= 0x84;
-		i2cstart();
-		i2cbw(RTC_I2C_ADDR_W);
-		i2cbw(0x0F);
-		i2cbw(dat2);
-		i2cstop();
-
-		/* Default time 2021-01-01 Friday 00:00:00, 24h mode */
-		i2cstart();
-		i2cbw(RTC_I2C_ADDR_W);
-		i2cbw(0x00);
-		i2cbw(0x00); /* sec  */
-		i2cbw(0x00); /* min  */
-		i2cbw(0x80); /* hour (24h flag) */
-		i2cbw(0x05); /* week */
-		i2cbw(0x01); /* day  */
-		i2cbw(0x01); /* mon  */
-		i2cbw(0x21); /* year */
-		i2cstop();
-
-		/* write disable */
-		dat2 &= (u8)~0x84;
-		dat1 &= (u8)~0x80;
-		i2cstart();
-		i2cbw(RTC_I2C_ADDR_W);
-		i2cbw(0x10);
-		i2cbw(dat1);
-		i2cstop();
-		i2cstart();
-		i2cbw(RTC_I2C_ADDR_W);
-		i2cbw(0x0F);
-		i2cbw(dat2);
-		i2cstop();
+	if (I2C_Read(RTC_I2C_ADDR, 0x0F, st, 2) != I2C_OK)
+		return;
+
+	if (st[0] & 0x01)
+	{
+		/* clear WRTC2/WRTC3 and WRTC1 if set */
+		if (st[0] & 0x84)
+			rtc_write1(0x0F, st[0] & (u8)~0x84);
+		if (st[1] & 0x80)
+			rtc_write1(0x10, st[1] & (u8)~0x80);
+
+		sd2058_write_enable(st[0], st[1]);
+		rtc_write(0x00, (const u8 *)deftime, 7);
+		sd2058_write_disable(st[0], st[1]);
 	}
 }
 
@@ -483,109 +282,55 @@ static u8 RTC_WeekdayCalc(u8 year, u8 month, u8 day)
 	return week;
 }
 
-/* SD2058: apply time configuration passed in BCD array prtc_set[0..6]. */
+/* SD2058: apply time configuration passed in BCD array prtc_set[0..6] (Y..S). */
 static void rtc_config(u8 *prtc_set)
 {
-	u8 dat, dat1;
-
-	/* Read status */
-	i2cstart();
-	i2cbw(RTC_I2C_ADDR_W);
-	i2cbw(0x0F);
-	i2cstart();
-	i2cbw(RTC_I2C_ADDR_R);
-	dat = i2cbr();
-	mack();
-	dat1 = i2cbr();
-	mnak();
-	i2cstop();
-
-	/* write enable */
-	dat1 |= 0x80;
-	i2cstart();
-	i2cbw(RTC_I2C_ADDR_W);
-	i2cbw(0x10);
-	i2cbw(dat1);
-	i2cstop();
-	dat |= 0x84;
-	i2cstart();
-	i2cbw(RTC_I2C_ADDR_W);
-	i2cbw(0x0F);
-	i2cbw(dat);
-	i2cstop();
-
-	/* write time */
-	i2cstart();
-	i2cbw(RTC_I2C_ADDR_W);
-	i2cbw(0x00);
-	i2cbw(prtc_set[6]); /* sec  */
-	i2cbw(prtc_set[5]); /* min  */
-	i2cbw(prtc_set[4]); /* hour */
-	i2cbw(prtc_set[3]); /* week */
-	i2cbw(prtc_set[2]); /* day  */
-	i2cbw(prtc_set[1]); /* mon  */
-	i2cbw(prtc_set[0]); /* year */
-	i2cstop();
-
-	/* write disable */
-	dat &= (u8)~0x84;
-	dat1 &= (u8)~0x80;
-	i2cstart();
-	i2cbw(RTC_I2C_ADDR_W);
-	i2cbw(0x10);
-	i2cbw(dat1);
-	i2cstop();
-	i2cstart();
-	i2cbw(RTC_I2C_ADDR_W);
-	i2cbw(0x0F);
-	i2cbw(dat);
-	i2cstop();
+	u8 st[2]; /* 0x0F (CTR2), 0x10 (CTR3) */
+	u8 regs[7];
+	u8 i;
+
+	if (I2C_Read(RTC_I2C_ADDR, 0x0F, st, 2) != I2C_OK)
+		return;
+
+	for (i = 0; i < 7; i++)
+		regs[i] = prtc_set[6 - i]; /* 0x00..0x06: sec..year */
+
+	sd2058_write_enable(st[0], st[1]);
+	rtc_write(0x00, regs, 7);
+	sd2058_write_disable(st[0], st[1]);
 }
 
-/* SD2058: read time, convert and mirror to DGUS VPs (0x0010..). */
-static void RTC_ReadDGUS(void)
+/* SD2058: decode a completed time read (0x00..0x06) and set the software clock. */
+static void RTC_ReadAndSync_1(void)
 {
-	u8 rtcdata[8];
 	u8 i, n, m;
 
-	i2cstart();
-	i2cbw(RTC_I2C_ADDR_W);
-	i2cbw(0x00);
-	i2cstart();
-	i2cbw(RTC_I2C_ADDR_R);
-	for (i = 6; i > 0; i--)
-	{
-		rtcdata[i] = i2cbr();
-		mack();
-	}
-	rtcdata[0] = i2cbr();
-	mnak();
-	i2cstop();
+	if (!rtc_read_time())
+		return;
 
-	rtcdata[4] &= 0x7F; /* clear 12/24h flag bit for conversion */
+	Rtcdata[4] &= 0x7F; /* clear 12/24h flag bit for conversion */
 
 	for (i = 0; i < 3; i++)
 	{
-		n = rtcdata[i] / 16;
-		m = rtcdata[i] % 16;
-		rtcdata[i] = n * 10 + m;
+		n = Rtcdata[i] / 16;
+		m = Rtcdata[i] % 16;
+		Rtcdata[i] = n * 10 + m;
 	}
 	for (i = 4; i < 7; i++)
 	{
-		n = rtcdata[i] / 16;
-		m = rtcdata[i] % 16;
-		rtcdata[i] = n * 10 + m;
+		n = Rtcdata[i] / 16;
+		m = Rtcdata[i] % 16;
+		Rtcdata[i] = n * 10 + m;
 	}
 
-	rtcdata[7] = 0; /* reserved */
-
-	DGUS_WriteBytes(0x0010, (u8 *)rtcdata, 8);
+	rtc_sync_clock(0);
 }
 
 /* Check DGUS time set trigger at 0x009C.. and apply to SD2058 */
 static void RTC_CheckSetCommand(void)
 {
 	u8 rtc_parm[8], rtc_set[8];
+	u8 i;
 
 	DGUS_ReadBytes(0x009C, rtc_parm, 4);
 	if ((rtc_parm[0] == 0x5A) && (rtc_parm[1] == 0xA5))
@@ -600,56 +345,108 @@ static void RTC_CheckSetCommand(void)
 
 		rtc_config(rtc_set);
 
-		rtc_parm[0] = 0;
-		rtc_parm[1] = 0;
-		DGUS_WriteBytes(0x009C, rtc_parm, 2);
+		for (i = 0; i < 6; i++)
+			Rtcdata[(i < 3) ? i : i + 1] = rtc_parm[2 + i]; /* decimal Y M D . H M S */
+		Rtcdata[3] = rtc_set[3];
+		rtc_sync_clock(1);
+
+		DGUS_Write_VP(0x009C, 0); /* clear trigger */
 	}
 }
 
-/* SD2058 periodic service */
-static void RTC_Service_SD2058(void)
+/* Mirror the software clock to DGUS VPs 0x0010..0x0013
+   (Year/Month, Day/Week, Hour/Minute, Second/Reserved). Only the span of
+   words that differ from the last published values is written, in one
+   DGUS RAM burst; usually that is just the seconds word. */
+static void rtc_publish(void)
 {
-	if (RTC_Flog == 0)
-	{
-		RTC_Flog = 1;
-		RTC_InitDefault_1();
-	}
-	if (sys_tick_rtc >= 500)
-	{
-		RTC_ReadDGUS();
-		sys_tick_rtc = 0;
-	}
-	RTC_CheckSetCommand();
+	u16 w[4];
+	u8 first, last;
+
+	w[0] = ((u16)clock_now.year << 8) | clock_now.month;
+	w[1] = ((u16)clock_now.day << 8) | clock_now.week;
+	w[2] = ((u16)clock_now.hour << 8) | clock_now.min;
+	w[3] = (u16)clock_now.sec << 8; /* low byte reserved */
+
+	for (first = 0; first < 4 && rtc_vp_valid && w[first] == rtc_vp[first]; first++)
+		;
+	if (first == 4)
+		return; /* nothing changed */
+	for (last = 3; last > first && rtc_vp_valid && w[last] == rtc_vp[last]; last--)
+		;
+
+	DGUS_WriteWords(RTC_VP + first, &w[first], (u8)(last - first + 1));
+	for (; first <= last; first++)
+		rtc_vp[first] = w[first];
+	rtc_vp_valid = 1;
 }
 
+#endif /* SELECT_RTC_TYPE */
+
 /* ========= Public entry ======================================================== */
 
 /**
- * @brief Periodic RTC service. Call in main loop.
- *        Select backend via SELECT_RTC_TYPE and/or Select_rtc.
+ * @brief Periodic RTC service. Runs as a scheduler task every RTC_POLL_MS
+ *        (see main.c). The DGUS time VPs follow the software clock (lib/clock)
+ *        and are written once per second. The chip is read on the I2C engine
+ *        every RTC_RESYNC_MIN minutes (every RTC_PERIOD_MS until a read
+ *        succeeds) to resync the clock; the time-set VPs are polled every
+ *        RTC_PERIOD_MS. Select backend via SELECT_RTC_TYPE and/or Select_rtc.
  */
 void RTC_Service(void)
 {
 #if SELECT_RTC_TYPE
+	u16 now;
+
+	if (Clock_Update())
+		rtc_publish();
+
+	if (rtc_busy)
+	{
+		if (!I2C_Done(&rtc_xfer))
+			return;
+		rtc_busy = 0;
+
+		if (Select_rtc == 1)
+			RTC_ReadAndSync(); /* RX8130 */
+		else if (Select_rtc == 2)
+			RTC_ReadAndSync_1(); /* SD2058 */
+		if (rtc_xfer.status != I2C_OK || !clock_valid)
+			rtc_periods = RTC_RESYNC_PERIODS; /* retry on the next period */
+		else
+			rtc_publish();
+	}
+
+	now = sys_tick_get();
+	if ((u16)(now - rtc_last) < RTC_PERIOD_MS)
+		return;
+	rtc_last = now;
+
 	if (Select_rtc == 1)
 	{ /* RX8130 */
 		if (RTC_Flog == 0)
 		{
 			RTC_Flog = 1;
 			RTC_InitDefault();
-		}
-		if (sys_tick_rtc >= 500)
-		{
-			RTC_ReadAndSync();
-			sys_tick_rtc = 0;
+			rtc_periods = RTC_RESYNC_PERIODS; /* first read now */
 		}
 		RTC_Set_Time();
 	}
 	else if (Select_rtc == 2)
 	{ /* SD2058 */
-		RTC_Service_SD2058();
+		if (RTC_Flog == 0)
+		{
+			RTC_Flog = 1;
+			RTC_InitDefault_1();
+			rtc_periods = RTC_RESYNC_PERIODS;
+		}
+		RTC_CheckSetCommand();
+	}
+
+	if (!rtc_busy && ++rtc_periods >= RTC_RESYNC_PERIODS)
+	{
+		rtc_periods = 0;
+		rtc_read_start((Select_rtc == 1) ? 0x10 : 0x00);
 	}
-#else
-	(void)Select_rtc; /* unused */
 #endif
 }
\ No newline at end of file
@@ -6,8 +6,8 @@
  *  Contact : recepsenbas@gmail.com
  *  Description :
  *    Clean-room reimplementation of the DWIN T5L real-time clock interface.
- *    Fully rewritten for SDCC / 8051 architecture with safe I2C bit-banging
- *    and DGUS variable synchronization.
+ *    Fully rewritten for SDCC / 8051 architecture on the calibrated I2C
+ *    master in lib/i2c, with DGUS variable synchronization.
  *
  *    Supports RX8130 and SD2058 RTC chips with legacy timing compatibility.
  *    Preserves functional behavior for DGUS panels without using any DWIN SDK code.
@@ -24,6 +24,6 @@
 
 extern __bit RTC_Flog;
 
-void Clock(void);
+void RTC_Service(void);
 
 #endif
\ No newline at end of file
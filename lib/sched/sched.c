@@ -0,0 +1,225 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : sched.c / sched.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Cooperative task scheduler on the Timer2 1ms tick.
+ *                Tasks run to completion in priority order at a fixed period
+ *                and phase; run time is checked against a per-task budget.
+ *                Sched_Delay() lets long jobs wait without blocking
+ *                higher-priority tasks; Sched_Idle() sleeps between ticks
+ *                and feeds the idle/busy load counters.
+ * ----------------------------------------------------------------------------- */
+#include "sched.h"
+#include "hal.h"
+
+__xdata sched_task_t sched_tasks[SCHED_MAX_TASKS]; // sorted by prio
+__xdata u8 sched_count = 0;
+static __xdata u8 sched_prio_now = SCHED_PRIO_IDLE; // prio of the running task
+
+#define PCON_IDL 0x01 // PCON.0: stop the CPU clock until the next interrupt
+
+__xdata u32 sched_idle_ms = 0;
+__xdata u32 sched_busy_ms = 0;
+__xdata u8 sched_load_pct = 0;
+static __xdata u32 sched_idle_us = 0; // idle time since the last load update
+
+/**
+ * @brief Register a periodic task.
+ *
+ * Tasks are kept sorted by priority (stable for equal priorities), so one
+ * scheduler pass visits them highest first.
+ *
+ * @param fn     Task body
+ * @param period Period in ms; 0 runs the task on every pass (polling work)
+ * @param phase  Delay of the first run in ms, to spread tasks with equal periods
+ * @param prio   0 = highest; higher-priority tasks may run inside Sched_Delay()
+ * @param budget Allowed run time in ms, 0 = unchecked
+ * @return Task index, or SCHED_NO_TASK if SCHED_MAX_TASKS is reached
+ */
+u8 Sched_Add(sched_fn_t fn, u16 period, u16 phase, u8 prio, u16 budget)
+{
+    u8 i;
+
+    if (sched_count >= SCHED_MAX_TASKS)
+        return SCHED_NO_TASK;
+
+    for (i = sched_count; i > 0 && sched_tasks[i - 1].prio > prio; i--)
+        sched_tasks[i] = sched_tasks[i - 1];
+
+    sched_tasks[i].fn = fn;
+    sched_tasks[i].period = period;
+    sched_tasks[i].due = sys_tick_get() + phase;
+    sched_tasks[i].prio = prio;
+    sched_tasks[i].running = 0;
+    sched_tasks[i].budget = budget;
+    sched_tasks[i].runs = 0;
+    sched_tasks[i].max_ms = 0;
+    sched_tasks[i].overruns = 0;
+    sched_count++;
+    return i;
+}
+
+/*
+ * One pass over the task table, running every due task whose priority is
+ * above 'limit'. Reentrant because Sched_Delay() nests passes: with the large
+ * model the locals would otherwise be static and shared between the levels.
+ */
+static void sched_pass(u8 limit) __reentrant
+{
+    u8 i;
+    __xdata sched_task_t *t;
+    u8 prev;
+    u16 now, start, took;
+
+    for (i = 0; i < sched_count; i++)
+    {
+        t = &sched_tasks[i];
+        if (t->prio >= limit)
+            break; // sorted: nothing below may run here
+        if (t->running)
+            continue;
+        now = sys_tick_get();
+        if (t->period && (s16)(now - t->due) < 0)
+            continue;
+
+        if (t->period)
+        {
+            t->due += t->period;
+            if ((s16)(now - t->due) >= 0)
+                t->due = now + t->period; // fell behind: skip, don't burst
+        }
+
+        prev = sched_prio_now;
+        sched_prio_now = t->prio;
+        t->running = 1;
+        start = now;
+
+        t->fn();
+
+        took = sys_tick_get() - start;
+        t->running = 0;
+        sched_prio_now = prev;
+
+        t->runs++;
+        if (took > t->max_ms)
+            t->max_ms = took;
+        if (t->budget && took > t->budget)
+            t->overruns++;
+    }
+}
+
+/**
+ * @brief Run one scheduler pass. Call repeatedly from the main loop.
+ */
+void Sched_Run(void)
+{
+    sched_pass(SCHED_PRIO_IDLE);
+}
+
+/**
+ * @brief Give due higher-priority tasks a chance to run.
+ *
+ * Only tasks with a higher priority than the caller are considered, and a
+ * task never re-enters itself, so a long job can call this from inside its
+ * own loop without recursion into the same code.
+ */
+void Sched_Yield(void)
+{
+    sched_pass(sched_prio_now);
+}
+
+/**
+ * @brief Wait 'ms' milliseconds while yielding to higher-priority tasks.
+ *
+ * Use instead of delay_ms() in long jobs (NOR waits, slow peripherals) so
+ * UART processing keeps running during the wait. Reentrant: a task woken
+ * here may itself call Sched_Delay().
+ */
+void Sched_Delay(u16 ms) __reentrant
+{
+    u16 start = sys_tick_get();
+    while ((u16)(sys_tick_get() - start) < ms)
+    {
+        Sched_Yield();
+        HAL_WAIT_TICK();
+    }
+}
+
+/**
+ * @brief Check whether a periodic task is due now.
+ *
+ * A long task can make earlier tasks in the table due while the pass is
+ * still running; the main loop must not sleep over them.
+ */
+u8 Sched_Due(void)
+{
+    u16 now = sys_tick_get();
+
+    for (u8 i = 0; i < sched_count; i++)
+        if (sched_tasks[i].period && (s16)(now - sched_tasks[i].due) >= 0)
+            return 1;
+    return 0;
+}
+
+/**
+ * @brief Sleep until the next Timer2 tick.
+ *
+ * Call from the main loop only when no task is due and no queue holds work.
+ * All remaining work is tick-gated (task periods, UART frame timeouts, the
+ * timer wheel), so nothing can become ready before the tick. Other
+ * interrupts (UART bytes) wake the core and it goes back to sleep.
+ * With IDLE_ENABLE 0 the same wait spins instead, keeping the accounting.
+ */
+void Sched_Idle(void)
+{
+    u16 tick = sys_tick_get();
+    u32 start = sys_time_us();
+
+    do
+    {
+#if IDLE_ENABLE
+        PCON |= PCON_IDL;
+#endif
+        HAL_WAIT_TICK();
+    } while (sys_tick_get() == tick);
+
+    sched_idle_us += sys_time_us() - start;
+}
+
+/**
+ * @brief Fold the idle time of the last window into the load counters.
+ *
+ * Runs as a scheduler task every LOAD_PERIOD_MS; the window is measured on
+ * the us clock, so a late run does not skew the ratio.
+ */
+void Sched_LoadUpdate(void)
+{
+    static __xdata u32 last_us = 0;
+    static __xdata u32 idle_rem = 0, busy_rem = 0; // sub-ms carry
+    u32 now = sys_time_us();
+    u32 win = now - last_us;
+    u32 idle = sched_idle_us;
+
+    last_us = now;
+    sched_idle_us = 0;
+    if (idle > win)
+        idle = win;
+
+    idle_rem += idle;
+    busy_rem += win - idle;
+    sched_idle_ms += idle_rem / 1000;
+    sched_busy_ms += busy_rem / 1000;
+    idle_rem %= 1000;
+    busy_rem %= 1000;
+
+    if (win)
+    {
+        u16 idle_pct = (u16)((u32)idle * 100 / win); // idle <= win, so at most 100
+
+        if (idle_pct > 100)
+            idle_pct = 100;
+        sched_load_pct = (u8)(100 - idle_pct);
+    }
+}
@@ -0,0 +1,54 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : sched.c / sched.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Cooperative task scheduler on the Timer2 1ms tick.
+ *                Tasks run to completion in priority order at a fixed period
+ *                and phase; run time is checked against a per-task budget.
+ *                Sched_Delay() lets long jobs wait without blocking
+ *                higher-priority tasks.
+ * ----------------------------------------------------------------------------- */
+#ifndef __SCHED_H__
+#define __SCHED_H__
+
+#include "t5l1.h"
+#include "config.h"
+#include "timer.h"
+
+#define SCHED_NO_TASK 0xFF  // Sched_Add() result when the table is full
+#define SCHED_PRIO_IDLE 0xFF // priority of code running outside any task
+
+typedef void (*sched_fn_t)(void);
+
+typedef struct
+{
+    sched_fn_t fn;  // task body, runs to completion
+    u16 period;     // ms between runs, 0 = every scheduler pass
+    u16 due;        // sys_tick_ms of the next run
+    u8 prio;        // 0 = highest
+    u8 running;     // set while the body is on the stack (no re-entry)
+    u16 budget;     // allowed ms per run, 0 = unchecked
+    u16 runs;       // completed runs (wraps)
+    u16 max_ms;     // longest observed run
+    u16 overruns;   // runs that exceeded budget
+} sched_task_t;
+
+extern __xdata sched_task_t sched_tasks[SCHED_MAX_TASKS];
+extern __xdata u8 sched_count;
+
+/* Load accounting, updated by Sched_LoadUpdate() */
+extern __xdata u32 sched_idle_ms; // total ms spent in Sched_Idle()
+extern __xdata u32 sched_busy_ms; // total ms spent elsewhere
+extern __xdata u8 sched_load_pct; // busy share of the last window, 0..100
+
+u8 Sched_Add(sched_fn_t fn, u16 period, u16 phase, u8 prio, u16 budget);
+void Sched_Run(void);
+void Sched_Yield(void);
+void Sched_Delay(u16 ms) __reentrant;
+u8 Sched_Due(void);
+void Sched_Idle(void);
+void Sched_LoadUpdate(void);
+
+#endif
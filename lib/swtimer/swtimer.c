@@ -0,0 +1,178 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : swtimer.c / swtimer.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Hierarchical software timer wheel on the Timer2 1ms tick.
+ *                O(1) start/stop, one-shot and periodic timers, callbacks
+ *                run from the main loop (SwTimer_Process). Time is kept as a
+ *                32-bit millisecond count, so no 16-bit wraparound.
+ * ----------------------------------------------------------------------------- */
+#include "swtimer.h"
+
+/*
+ * Slot numbering: level L, index i -> L * SWT_SLOTS + i. One extra list
+ * (SWT_RUN) holds the timers being expired right now, so a callback may
+ * stop any timer, including ones still waiting in the same batch.
+ */
+#define SWT_MASK (SWT_SLOTS - 1)
+#define SWT_RUN (SWT_LEVELS * SWT_SLOTS)
+
+static __xdata swtimer_t __xdata *swt_wheel[SWT_LEVELS * SWT_SLOTS + 1];
+static __xdata u32 swt_now = 0;       // wheel time in ms
+static __xdata u32 swt_last_tick = 0; // sys_time_ms() already accounted for
+
+/* Zero-initialised timers have no callback yet, so they count as idle too */
+#define swt_armed(t) ((t)->slot != SWT_IDLE && (t)->cb)
+
+static void swt_link(__xdata swtimer_t *t, u8 slot)
+{
+    t->slot = slot;
+    t->prev = 0;
+    t->next = swt_wheel[slot];
+    if (t->next)
+        t->next->prev = t;
+    swt_wheel[slot] = t;
+}
+
+static void swt_unlink(__xdata swtimer_t *t)
+{
+    if (t->prev)
+        t->prev->next = t->next;
+    else
+        swt_wheel[t->slot] = t->next;
+    if (t->next)
+        t->next->prev = t->prev;
+    t->slot = SWT_IDLE;
+}
+
+/* Put a timer in the level whose span covers its remaining time. */
+static void swt_place(__xdata swtimer_t *t)
+{
+    u32 delta = t->expires - swt_now;
+    u32 when = t->expires;
+
+    if (delta < SWT_SLOTS)
+        swt_link(t, (u8)(when & SWT_MASK));
+    else if (delta < (1ul << (2 * SWT_BITS)))
+        swt_link(t, (u8)(SWT_SLOTS + ((when >> SWT_BITS) & SWT_MASK)));
+    else
+    {
+        if (delta >= (1ul << (3 * SWT_BITS)))
+            when = swt_now + (1ul << (3 * SWT_BITS)) - 1; // re-cascaded later
+        swt_link(t, (u8)(2 * SWT_SLOTS + ((when >> (2 * SWT_BITS)) & SWT_MASK)));
+    }
+}
+
+/* Move every timer of one upper-level slot down to where it now belongs. */
+static void swt_cascade(u8 slot)
+{
+    __xdata swtimer_t *t = swt_wheel[slot];
+    __xdata swtimer_t *next;
+
+    swt_wheel[slot] = 0;
+    while (t)
+    {
+        next = t->next;
+        swt_place(t);
+        t = next;
+    }
+}
+
+/**
+ * @brief Start (or restart) a timer.
+ * @param t         Timer object, owned by the caller (static __xdata)
+ * @param delay_ms  First expiry in ms after the last processed tick (0 -> 1)
+ * @param period_ms Re-arm period in ms after each expiry, 0 = one-shot
+ * @param cb        Callback, run from SwTimer_Process() in main context
+ * @param arg       Passed to cb
+ */
+void SwTimer_Start(__xdata swtimer_t *t, u32 delay_ms, u16 period_ms, swt_cb_t cb, void *arg)
+{
+    if (swt_armed(t))
+        swt_unlink(t);
+    if (delay_ms == 0)
+        delay_ms = 1;
+    t->expires = swt_now + delay_ms;
+    t->period = period_ms;
+    t->cb = cb;
+    t->arg = arg;
+    swt_place(t);
+}
+
+/**
+ * @brief Stop a timer. Safe on an idle timer and from inside callbacks.
+ */
+void SwTimer_Stop(__xdata swtimer_t *t)
+{
+    if (swt_armed(t))
+        swt_unlink(t);
+}
+
+/**
+ * @brief 1 while the timer is armed.
+ */
+u8 SwTimer_Active(__xdata swtimer_t *t)
+{
+    return swt_armed(t) ? 1 : 0;
+}
+
+/**
+ * @brief Wheel time in ms (32-bit, wraps after ~49 days).
+ */
+u32 SwTimer_Now(void)
+{
+    return swt_now;
+}
+
+/**
+ * @brief Advance the wheel to the current tick and run expired callbacks.
+ *
+ * Call from the main loop (registered as a scheduler task in main.c). Ticks
+ * that elapsed while the loop was busy are caught up one by one, so no expiry
+ * is skipped; per tick only one slot per level is touched.
+ */
+void SwTimer_Process(void)
+{
+    u32 tick;
+    u32 n;
+    __xdata swtimer_t *t;
+
+    tick = sys_time_ms();
+    n = tick - swt_last_tick;
+    swt_last_tick = tick;
+
+    while (n--)
+    {
+        swt_now++;
+        if ((swt_now & SWT_MASK) == 0)
+        {
+            if (((swt_now >> SWT_BITS) & SWT_MASK) == 0)
+                swt_cascade((u8)(2 * SWT_SLOTS + ((swt_now >> (2 * SWT_BITS)) & SWT_MASK)));
+            swt_cascade((u8)(SWT_SLOTS + ((swt_now >> SWT_BITS) & SWT_MASK)));
+        }
+
+        // Detach the due slot so callbacks can freely start/stop timers
+        swt_wheel[SWT_RUN] = swt_wheel[swt_now & SWT_MASK];
+        swt_wheel[swt_now & SWT_MASK] = 0;
+        for (t = swt_wheel[SWT_RUN]; t; t = t->next)
+            t->slot = SWT_RUN;
+
+        while ((t = swt_wheel[SWT_RUN]) != 0)
+        {
+            swt_unlink(t);
+            if (t->expires != swt_now)
+            {
+                swt_place(t); // parked for a longer delay, not due yet
+                continue;
+            }
+            if (t->period)
+            {
+                t->expires += t->period;
+                swt_place(t);
+            }
+            t->cb(t->arg);
+        }
+    }
+}
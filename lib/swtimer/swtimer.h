@@ -0,0 +1,45 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : swtimer.c / swtimer.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Hierarchical software timer wheel on the Timer2 1ms tick.
+ *                O(1) start/stop, one-shot and periodic timers, callbacks
+ *                run from the main loop (SwTimer_Process). Time is kept as a
+ *                32-bit millisecond count, so no 16-bit wraparound.
+ * ----------------------------------------------------------------------------- */
+#ifndef __SWTIMER_H__
+#define __SWTIMER_H__
+
+#include "t5l1.h"
+#include "timer.h"
+
+/* Wheel geometry: 3 levels x 64 slots -> 1ms / 64ms / 4096ms resolution,
+ * direct reach 262 s; longer delays are re-cascaded transparently. */
+#define SWT_BITS 6
+#define SWT_SLOTS (1u << SWT_BITS)
+#define SWT_LEVELS 3
+
+typedef void (*swt_cb_t)(void *arg);
+
+typedef struct swtimer
+{
+    struct swtimer __xdata *next; // slot list links (O(1) unlink)
+    struct swtimer __xdata *prev;
+    u32 expires;                  // absolute SwTimer_Now() of the next expiry
+    u16 period;                   // ms, 0 = one-shot
+    swt_cb_t cb;                  // called from SwTimer_Process()
+    void *arg;                    // passed to cb
+    u8 slot;                      // owning list, SWT_IDLE when stopped
+} swtimer_t;
+
+#define SWT_IDLE 0xFF
+
+void SwTimer_Start(__xdata swtimer_t *t, u32 delay_ms, u16 period_ms, swt_cb_t cb, void *arg);
+void SwTimer_Stop(__xdata swtimer_t *t);
+u8 SwTimer_Active(__xdata swtimer_t *t);
+u32 SwTimer_Now(void);
+void SwTimer_Process(void);
+
+#endif
@@ -10,6 +10,11 @@
  * ----------------------------------------------------------------------------- */
 
 #include "sys.h"
+#include "sched.h"
+#include "prof.h"
+#include "i2c.h"
+#include "hal.h"
+#include "pool.h"
 
 void Sys_Init(void)
 {
@@ -18,8 +23,8 @@ void Sys_Init(void)
     CKCON = 0x00;     // CPU running=0, 1T mode
     D_PAGESEL = 0x02; // set DPTR upper page for MOVX
 
-    IP0 = 0x00;
-    IP1 = 0x00; // Interrupt priority default
+    IP0 = IRQ_IP0;
+    IP1 = IRQ_IP1; // Interrupt priority per group, see IRQ_PRIO_Gx in config.h
     RAMMODE = 0x00;
     /* IO mode */
     P0MDOUT = 0x53; // p0.0 p0.1 forced push for 485 direction control P0.4 leads to serial port 2 P0.6 leads to serial port 3
@@ -30,9 +35,15 @@ void Sys_Init(void)
     P3 = 0x00;
     MUX_SEL |= 0x00; // WDT off, UART2, UART3 and CAN are not led out
 
+#if PROFILE_ENABLE
+    Prof_Init(); // Timer0 = free-running profiling clock
+#else
     // Timer0_Init();
+#endif
     // Timer1_Init();
     Timer2_Init();
+    I2C_Init(); // bit timing is calibrated against Timer2
+    Pool_Init(); // frame buffers, before Uart_Init() takes the RX blocks
 }
 
 /* DGUS RAM access modes */
@@ -44,17 +55,32 @@ void Sys_Init(void)
 /* Wait for APP_ACK to go high */
 static void dgus_wait_ack_high(void)
 {
-    while (!APP_ACK)
-        ;
+    HAL_DGUS_WAIT_ACK();
 }
 /* Kick the APP and wait for it to finish */
 static void dgus_kick_and_wait_done(void)
 {
-    APP_EN = 1;
-    while (APP_EN)
-        ;
-    while (!APP_ACK)
-        ;
+    HAL_DGUS_KICK();
+}
+
+/* Burst over the 32-bit cells from the even VP 'addr': one address set-up,
+   then ADR_INC moves to the next cell after every access */
+static void dgus_burst_begin(u16 addr, u8 mode)
+{
+    u16 word_addr = addr >> 1;
+
+    ADR_H = 0x00;
+    ADR_M = (u8)(word_addr >> 8);
+    ADR_L = (u8)(word_addr);
+    ADR_INC = 0x01;
+    RAMMODE = mode;
+    dgus_wait_ack_high();
+}
+
+static void dgus_burst_end(void)
+{
+    RAMMODE = DGUS_MODE_IDLE;
+    ADR_INC = 0x00; // single-cell accesses elsewhere rely on it
 }
 
 /**
@@ -65,6 +91,7 @@ u16 DGUS_Read_VP(u16 addr)
 {
     u16 word_addr = addr >> 1; // DGUS word address
     u16 val;
+    PROF_BEGIN(PROF_DGUS_READ);
 
     // Set address
     ADR_H = 0x00;
@@ -83,6 +110,7 @@ u16 DGUS_Read_VP(u16 addr)
         val = ((u16)DATA3 << 8) | (u16)DATA2; // even
 
     RAMMODE = 0x00; // idle
+    PROF_END(PROF_DGUS_READ);
     return val;
 }
 
@@ -93,6 +121,7 @@ u16 DGUS_Read_VP(u16 addr)
 void DGUS_Write_VP(u16 addr, u16 val)
 {
     u16 word_addr = addr >> 1;
+    PROF_BEGIN(PROF_DGUS_WRITE);
     // Set address
     ADR_H = 0x00;
     ADR_M = (u8)(word_addr >> 8);
@@ -122,6 +151,7 @@ void DGUS_Write_VP(u16 addr, u16 val)
     }
 
     RAMMODE = 0x00; // idle
+    PROF_END(PROF_DGUS_WRITE);
 }
 
 /**
@@ -164,20 +194,141 @@ void DGUS_WriteBytes(u16 addr, const u8 *buf, u16 len)
     delay_ms(20);
 }
 
+/**
+ * @brief Write 'words' consecutive VPs in one DGUS RAM burst.
+ *        The address is set once and auto-incremented (ADR_INC) over the
+ *        32-bit cells (two VPs each); an odd start VP or a single trailing VP
+ *        goes through DGUS_Write_VP(). Unlike DGUS_WriteBytes() there is no
+ *        settle delay afterwards.
+ * @param addr   Starting VP address
+ * @param val    Word values, one per VP
+ * @param words  Number of VPs to write
+ */
+void DGUS_WriteWords(u16 addr, const u16 *val, u8 words)
+{
+    if (!words)
+        return;
+
+    if (addr & 0x01)
+    {
+        DGUS_Write_VP(addr++, *val++);
+        words--;
+    }
+
+    if (words >= 2)
+    {
+        PROF_BEGIN(PROF_DGUS_WRITE);
+        dgus_burst_begin(addr, DGUS_MODE_WRITE); // all four lanes
+        while (words >= 2)
+        {
+            DATA3 = (u8)(val[0] >> 8);
+            DATA2 = (u8)(val[0]);
+            DATA1 = (u8)(val[1] >> 8);
+            DATA0 = (u8)(val[1]);
+            dgus_kick_and_wait_done();
+            val += 2;
+            addr += 2;
+            words -= 2;
+        }
+        dgus_burst_end();
+        PROF_END(PROF_DGUS_WRITE);
+    }
+
+    if (words)
+        DGUS_Write_VP(addr, *val);
+}
+
+/**
+ * @brief Write 'words' consecutive VPs from [HI, LO] byte pairs in one DGUS
+ *        RAM burst, like DGUS_WriteWords() and without a settle delay. For
+ *        data that arrives in VP byte order, e.g. Modbus registers.
+ * @param addr   Starting VP address
+ * @param buf    Big-endian words, 2 * words bytes
+ * @param words  Number of VPs to write
+ */
+void DGUS_WriteBurst(u16 addr, const u8 *buf, u8 words)
+{
+    if (!words)
+        return;
+
+    if (addr & 0x01)
+    {
+        DGUS_Write_VP(addr++, (u16)buf[0] << 8 | buf[1]);
+        buf += 2;
+        words--;
+    }
+
+    if (words >= 2)
+    {
+        PROF_BEGIN(PROF_DGUS_WRITE);
+        dgus_burst_begin(addr, DGUS_MODE_WRITE);
+        while (words >= 2)
+        {
+            DATA3 = buf[0];
+            DATA2 = buf[1];
+            DATA1 = buf[2];
+            DATA0 = buf[3];
+            dgus_kick_and_wait_done();
+            buf += 4;
+            addr += 2;
+            words -= 2;
+        }
+        dgus_burst_end();
+        PROF_END(PROF_DGUS_WRITE);
+    }
+
+    if (words)
+        DGUS_Write_VP(addr, (u16)buf[0] << 8 | buf[1]);
+}
+
 /**
  * @brief Read 'words' DGUS VPs and unpack to bytes as [HI, LO] pairs.
+ *        Whole cells (two VPs) are read in one auto-increment burst; an odd
+ *        start VP or a single trailing VP goes through DGUS_Read_VP().
  * @param addr   Starting VP address (BYTE-addressed, e.g. 0x2000)
  * @param buf    Destination buffer (size >= 2 * words)
  * @param words  Number of 16-bit words to read
- * @return 1 on success
  */
 void DGUS_ReadBytes(u16 addr, u8 *buf, u16 words)
 {
-    for (u16 i = 0; i < words; i++)
+    u16 v;
+
+    if (!words)
+        return;
+
+    if (addr & 0x01)
+    {
+        v = DGUS_Read_VP(addr++);
+        buf[0] = (u8)(v >> 8); // HI
+        buf[1] = (u8)v;        // LO
+        buf += 2;
+        words--;
+    }
+
+    if (words >= 2)
+    {
+        PROF_BEGIN(PROF_DGUS_READ);
+        dgus_burst_begin(addr, DGUS_MODE_READ);
+        while (words >= 2)
+        {
+            dgus_kick_and_wait_done();
+            buf[0] = DATA3; // even VP
+            buf[1] = DATA2;
+            buf[2] = DATA1; // odd VP
+            buf[3] = DATA0;
+            buf += 4;
+            addr += 2;
+            words -= 2;
+        }
+        dgus_burst_end();
+        PROF_END(PROF_DGUS_READ);
+    }
+
+    if (words)
     {
-        u16 v = DGUS_Read_VP((u16)(addr + i)); // consecutive VPs
-        buf[2u * i] = (u8)(v >> 8);            // HI
-        buf[2u * i + 1] = (u8)(v & 0xFF);      // LO
+        v = DGUS_Read_VP(addr);
+        buf[0] = (u8)(v >> 8);
+        buf[1] = (u8)v;
     }
 }
 
@@ -215,7 +366,7 @@ u8 DGUS_GetPageID(void)
     u8 page_id_reg[2] = {0x00, 0x00};
 
     // 0x0014 = Page ID register (1 word)
-    DGUS_ReadBytes(PIC_Now_VP, page_id_reg, 2);
+    DGUS_ReadBytes(PIC_Now_VP, page_id_reg, 1);
 
     return page_id_reg[1];
 }
@@ -252,7 +403,7 @@ static u8 DGUS_NOR_WaitDone(u16 timeout_ms)
         DGUS_ReadBytes(NOR_FLASH_RW_VP, st, 1); // first word: [HI,LO], HI=status
         if (st[0] == 0x00)
             return 1;
-        delay_ms(1);
+        Sched_Delay(1); // keep higher-priority tasks (UART) running
     }
     return 0;
 }
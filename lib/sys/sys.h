@@ -20,6 +20,8 @@ void Sys_Init(void);
 u16 DGUS_Read_VP(u16 addr);
 void DGUS_Write_VP(u16 addr, u16 val);
 void DGUS_WriteBytes(u16 addr, const u8 *buf, u16 len);
+void DGUS_WriteWords(u16 addr, const u16 *val, u8 words);
+void DGUS_WriteBurst(u16 addr, const u8 *buf, u8 words);
 void DGUS_ReadBytes(u16 addr, u8 *buf, u16 words);
 void DGUS_WriteText(u16 addr, const char *text);
 u8 DGUS_GetPageID(void);
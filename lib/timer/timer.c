@@ -5,21 +5,120 @@
  *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
  *  Contact : recepsenbas@gmail.com
  *  Description : System timing library for DWIN T5L.
- *                Provides 1ms base tick, delay function, and UART timeout handling.
+ *                Provides 1ms base tick, delay function, UART timeout handling
+ *                and a 32-bit ms / us monotonic timebase from Timer2.
  * ----------------------------------------------------------------------------- */
 #include "timer.h"
+#include "prof.h"
+#include "i2c.h"
+#include "hal.h"
 
 volatile u32 t0_count = 0;
 volatile u32 t1_count = 0;
-volatile u16 sys_tick_ms = 0;
-volatile u16 sys_tick_rtc = 0;
-volatile u16 monitor_ms = 0;
+volatile MEM_HOT u16 sys_tick_ms = 0;
+volatile MEM_WARM u32 sys_uptime_ms = 0; // 32-bit ms since boot (~49 days)
+volatile MEM_WARM u32 sys_uptime_us = 0; // us at the last Timer2 tick (wraps ~71 min)
+
+#if IRQ_LATENCY_MEASURE
+#define IRQ_LAT_LIMIT ((u16)(IRQ_LAT_LIMIT_US * T2_TICKS_PER_MS / 1000UL))
+
+volatile __xdata u16 irq_lat_min = 0xFFFF;
+volatile __xdata u16 irq_lat_max = 0;
+volatile __xdata u16 irq_lat_late = 0;
+
+/**
+ * @brief Restart the Timer2_ISR entry latency statistics.
+ */
+void Irq_LatencyReset(void)
+{
+    __bit ea = EA;
+
+    EA = 0;
+    irq_lat_min = 0xFFFF;
+    irq_lat_max = 0;
+    irq_lat_late = 0;
+    EA = ea;
+}
+#endif
 
 void delay_ms(u16 ms)
 {
-    u16 start = sys_tick_ms;
-    while ((u16)(sys_tick_ms - start) < ms)
-        ;
+    u16 start = sys_tick_get();
+    while ((u16)(sys_tick_get() - start) < ms)
+        HAL_WAIT_TICK();
+}
+
+/**
+ * @brief Tear-free read of the 16-bit sys_tick_ms.
+ *
+ * The 8051 reads the counter one byte at a time, so a Timer2 tick between
+ * the two bytes could return a value off by 256. Interrupts are held off for
+ * the two MOVX reads only; EA is restored, not forced on.
+ */
+u16 sys_tick_get(void)
+{
+    u16 t;
+    __bit ea = EA;
+
+    EA = 0;
+    t = sys_tick_ms;
+    EA = ea;
+    return t;
+}
+
+/**
+ * @brief 32-bit monotonic millisecond counter (main context).
+ */
+u32 sys_time_ms(void)
+{
+    u32 t;
+    __bit ea = EA;
+
+    EA = 0;
+    t = sys_uptime_ms;
+    EA = ea;
+    return t;
+}
+
+/**
+ * @brief 32-bit monotonic microsecond clock (main context).
+ *
+ * Combines the ISR-maintained sys_uptime_us with the live Timer2 count.
+ * Resolution is one Timer2 count (~58 ns, rounded to us). TH2/TL2 are read
+ * high-low-high to catch a carry, and a pending TF2 (reload happened, ISR not
+ * yet run) adds the missing millisecond so the result never steps back.
+ * Wraps after ~71 minutes; use unsigned differences for intervals.
+ */
+u32 sys_time_us(void)
+{
+    u32 base;
+    u8 th, tl;
+    __bit ea = EA;
+
+    EA = 0;
+    th = TH2;
+    tl = TL2;
+    if (TH2 != th)
+    {
+        th = TH2;
+        tl = TL2;
+    }
+    base = sys_uptime_us;
+    if (TF2)
+    {
+        // Overflow is pending: the count restarted from T2_RELOAD
+        th = TH2;
+        tl = TL2;
+        if (TH2 != th)
+        {
+            th = TH2;
+            tl = TL2;
+        }
+        base += 1000;
+    }
+    EA = ea;
+
+    return base + (u16)(((u32)((((u16)th << 8) | tl) - (u16)T2_RELOAD) * T2_US_SCALE) >> 16);
 }
 
 void Timer0_Init(void)
@@ -47,35 +146,71 @@ void Timer2_Init(void)
     TH2 = 0x00;
     TL2 = 0x00;
     T2CON = 0x70;
-    TRL2H = 0xBC; // 1ms timer
-    TRL2L = 0xCD;
+    TRL2H = (u8)(T2_RELOAD >> 8); // 1ms timer (0xBCCD)
+    TRL2L = (u8)T2_RELOAD;
     IEN0 |= 0x20; // Start timer 2
     TR2 = 0x01;
     ET2 = 1; // T2 timer interrupt enable control bit
     EA = 1;
 }
 
-// Timer0 interrupt service routine (1ms interval)
+// Timer0 interrupt service routine (1ms interval, or profiling clock overflow)
 void Timer0_ISR(void) __interrupt(1)
 {
+#if PROFILE_ENABLE
+    prof_t0_hi++; // free-running, no reload
+#else
     TH0 = 0xBC;
     TL0 = 0xCD;
     t0_count++;
+#endif
 }
-// Timer1 interrupt service routine (1ms interval)
+// Timer1 interrupt service routine (1ms interval, or I2C engine half-bit clock)
 void Timer1_ISR(void) __interrupt(3)
 {
+#if I2C_ASYNC
+    I2C_Tick(); // mode 2 auto-reload, runs only while a transfer is queued
+#else
     TH1 = 0xBC;
     TL1 = 0xCD;
     t1_count++;
+#endif
 }
-// Timer2 interrupt service routine (1ms interval)
-void Timer2_ISR(void) __interrupt(5)
+/*
+ * Timer2 interrupt service routine (1ms interval).
+ * Runs in the RX register bank, so it must not call functions.
+ * With IRQ_LATENCY_MEASURE the count since the reload is the entry latency:
+ * the fixed vector/prologue cost (irq_lat_min) plus whatever held the CPU
+ * off (EA-masked sections, ISRs on the same or a higher level). Only UART5
+ * RX weighs less than Timer2 on the same level, so this tracks what the UART
+ * RX ISRs see.
+ */
+void Timer2_ISR(void) __interrupt(5) IRQ_USING_RX
 {
+#if IRQ_LATENCY_MEASURE
+    {
+        u8 th = TH2, tl = TL2;
+        u16 lat;
+
+        if (TH2 != th)
+        {
+            th = TH2;
+            tl = TL2;
+        }
+        lat = (((u16)th << 8) | tl) - (u16)T2_RELOAD;
+        if (lat < irq_lat_min)
+            irq_lat_min = lat;
+        if (lat > irq_lat_max)
+            irq_lat_max = lat;
+        if (lat > IRQ_LAT_LIMIT)
+            irq_lat_late++;
+    }
+#endif
+    PROF_ISR_BEGIN(PROF_ISR_TIMER2);
     TF2 = 0;
     sys_tick_ms++;
-    monitor_ms++;
-    sys_tick_rtc++;
+    sys_uptime_ms++;
+    sys_uptime_us += 1000;
 
 #if UART5_ENABLE
     if (T_O5 > 0)
@@ -94,4 +229,5 @@ void Timer2_ISR(void) __interrupt(5)
     if (T_O2 > 0)
         T_O2--;
 #endif
+    PROF_ISR_END(PROF_ISR_TIMER2);
 }
\ No newline at end of file
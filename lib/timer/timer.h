@@ -5,27 +5,47 @@
  *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
  *  Contact : recepsenbas@gmail.com
  *  Description : System timing library for DWIN T5L.
- *                Provides 1ms base tick, delay function, and UART timeout handling.
+ *                Provides 1ms base tick, delay function, UART timeout handling
+ *                and a 32-bit ms / us monotonic timebase from Timer2.
  * ----------------------------------------------------------------------------- */
 #ifndef __TIMER_H__
 #define __TIMER_H__
 
 #include <stdint.h>
 #include "t5l1.h"
+#include "mem.h"
 #include "uart.h"
+#include "irq.h"
+
+/* Timer2 runs at FOSC/12 and reloads every 1 ms */
+#define T2_TICKS_PER_MS (FOSC / 12UL / 1000UL)                             // 17203 counts
+#define T2_RELOAD (65536UL - T2_TICKS_PER_MS)                              // 0xBCCD
+#define T2_US_SCALE ((65536000UL + T2_TICKS_PER_MS / 2) / T2_TICKS_PER_MS) // counts -> us, Q16
+#define T2_COUNTS_TO_US(c) ((u16)(((u32)(c) * T2_US_SCALE) >> 16))
 
 extern volatile u32 t0_count;
 extern volatile u32 t1_count;
-extern volatile u16 sys_tick_ms;
-extern volatile u16 sys_tick_rtc;
-extern volatile u16 monitor_ms;
+extern volatile MEM_HOT u16 sys_tick_ms;
+extern volatile MEM_WARM u32 sys_uptime_ms;
+extern volatile MEM_WARM u32 sys_uptime_us;
+
+#if IRQ_LATENCY_MEASURE
+/* Timer2 counts from overflow to Timer2_ISR entry (T2_COUNTS_TO_US for us) */
+extern volatile __xdata u16 irq_lat_min;
+extern volatile __xdata u16 irq_lat_max;
+extern volatile __xdata u16 irq_lat_late; // entries later than IRQ_LAT_LIMIT_US
+void Irq_LatencyReset(void);
+#endif
 
 void delay_ms(u16 ms);
+u16 sys_tick_get(void);
+u32 sys_time_ms(void);
+u32 sys_time_us(void);
 void Timer0_Init(void);
 void Timer1_Init(void);
 void Timer2_Init(void);
 void Timer0_ISR(void) __interrupt(1);
 void Timer1_ISR(void) __interrupt(3);
-void Timer2_ISR(void) __interrupt(5);
+void Timer2_ISR(void) __interrupt(5) IRQ_USING_RX;
 
 #endif
\ No newline at end of file
@@ -5,48 +5,357 @@
  *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
  *  Contact : recepsenbas@gmail.com
  *  Description : UART driver implementation for DWIN T5L (DGUS compatible).
- *                Supports UART2–UART5, interrupt-driven RX, polling TX, and DGUS
+ *                Supports UART2–UART5, interrupt-driven RX and TX, and DGUS
  *                protocol frame handling (0x82 / 0x83 commands with optional CRC).
+ *                Ports set to a Modbus UARTx_PROTO hand frames to lib/modbus.
+ *                Gateway routes (src/app/route_list.txt) forward frames or raw
+ *                bytes to another port before local handling.
  * ----------------------------------------------------------------------------- */
+#define ROUTE_DEFINE
 #include "uart.h"
 #define VP_FLAGS_DEFINE
 #include "vp_flags.h"
 #define UART_FLAGS_DEFINE
 #include "uart_flags.h"
+#include "prof.h"
+#include "hal.h"
+#include "pool.h"
+#include "ring.h"
+#include "modbus.h"
 
 __bit Crc_check_flog = 0;
 __bit Response_flog = 0;
 __bit g_in_download_mode = 0;
+__xdata u16 route_frames = 0;
+__xdata u16 route_drops = 0;
+__xdata u16 dgus_reply_drops = 0;
+
+/*
+ * RX: the ISR queues bytes in a 256-byte ring (the u8 index wraps by itself)
+ * and main moves them into a frame block. TX: main queues, the TX interrupt
+ * sends. Both use the SPSC macros of ring.h, so neither side masks EA.
+ */
+#define UART_RX_RING 256
+
+#if !RING_SIZE_OK(UART_TX_RING)
+#error "UART_TX_RING must be a power of two between 2 and 256"
+#endif
+#if !RING_SIZE_OK(UART_TXQ_LEN)
+#error "UART_TXQ_LEN must be a power of two between 2 and 256"
+#endif
+
+/* Queue one received byte, dropped when the ring is full */
+#define UART_RX_PUT(n, v)                                      \
+    do                                                         \
+    {                                                          \
+        if (!RING_FULL(R_H##n, R_T##n, UART_RX_RING))          \
+            RING_PUT(R_u##n, R_H##n, UART_RX_RING, (v));       \
+    } while (0)
+
+/*
+ * Node filter of an addressed port (UARTn_NODE): frames for another node are
+ * counted off from their LEN byte and never reach the ring, so a panel on a
+ * busy bus spends a few instructions per foreign byte. The header is held
+ * back until the ID matches. A byte after an idle line (T_On expired)
+ * restarts the hunt, so a broken frame cannot desynchronize the filter.
+ */
+#define NODE_HUNT 0     // waiting for 5A
+#define NODE_HDR 1      // 5A seen, waiting for A5
+#define NODE_ID 2       // header seen, ID next
+#define NODE_LEN 3      // frame accepted, LEN next
+#define NODE_PASS 4     // accepted, N_Kn bytes left to queue
+#define NODE_SKIP_LEN 5 // foreign frame, LEN next
+#define NODE_SKIP 6     // foreign frame, N_Kn bytes left to skip
+
+#define UART_NODE_RX(n, sbuf)                                              \
+    do                                                                     \
+    {                                                                      \
+        u8 b_ = (sbuf);                                                    \
+        if (!T_O##n)                                                       \
+            N_S##n = NODE_HUNT;                                            \
+        switch (N_S##n)                                                    \
+        {                                                                  \
+        case NODE_HDR:                                                     \
+            N_S##n = (b_ == DTHD2) ? NODE_ID : (b_ == DTHD1) ? NODE_HDR : NODE_HUNT; \
+            break;                                                         \
+        case NODE_ID:                                                      \
+            if (b_ == UART##n##_NODE || b_ == UART_NODE_ALL)               \
+            {                                                              \
+                UART_RX_PUT(n, DTHD1);                                     \
+                UART_RX_PUT(n, DTHD2);                                     \
+                UART_RX_PUT(n, b_);                                        \
+                N_S##n = NODE_LEN;                                         \
+            }                                                              \
+            else                                                           \
+                N_S##n = NODE_SKIP_LEN;                                    \
+            break;                                                         \
+        case NODE_LEN:                                                     \
+            UART_RX_PUT(n, b_);                                            \
+            N_K##n = b_;                                                   \
+            N_S##n = b_ ? NODE_PASS : NODE_HUNT;                           \
+            break;                                                         \
+        case NODE_PASS:                                                    \
+            UART_RX_PUT(n, b_);                                            \
+            if (!--N_K##n)                                                 \
+                N_S##n = NODE_HUNT;                                        \
+            break;                                                         \
+        case NODE_SKIP_LEN:                                                \
+            N_K##n = b_;                                                   \
+            N_S##n = b_ ? NODE_SKIP : NODE_HUNT;                           \
+            break;                                                         \
+        case NODE_SKIP:                                                    \
+            if (!--N_K##n)                                                 \
+                N_S##n = NODE_HUNT;                                        \
+            break;                                                         \
+        default:                                                           \
+            if (b_ == DTHD1)                                               \
+                N_S##n = NODE_HDR;                                         \
+            break;                                                         \
+        }                                                                  \
+    } while (0)
+
+/*
+ * TX block queues: whole pool blocks the transmitter sends straight from
+ * the block, next to the byte ring main composes into. Two classes per
+ * port, taken in this order at every frame boundary:
+ *   byte ring  answers composed by main (ACK, 0x83 reply, Modbus requests)
+ *   TQ_*       UART_TX_HIGH: routed frames, Modbus slave answers
+ *   TL_*       UART_TX_LOW: monitor auto-uploads
+ * A block starts only at a frame boundary: never while main is between
+ * uart_4_5_pin_ctrl(n, 1) and the release (TX_Cn), and once started it goes
+ * out whole, so an answer waits for one upload frame at most instead of
+ * the whole backlog. The tail of the block's queue (TX_Ln says which) hands
+ * it back as soon as its last byte is in SBUF; main returns it to the pool
+ * (UART_TQ_RECLAIM). With nothing left and no frame being composed the
+ * RS485 driver is released.
+ */
+#define UART_TR_ON2
+#define UART_TR_ON3
+#define UART_TR_ON4 TR4 = 1;
+#define UART_TR_ON5 TR5 = 1;
+#define UART_TR_OFF2
+#define UART_TR_OFF3
+#define UART_TR_OFF4 TR4 = 0;
+#define UART_TR_OFF5 TR5 = 0;
+
+/* Make the tail block of queue q (TQ or TL) of port n the one being sent */
+#define UART_BQ_START(q, n)                                       \
+    do                                                            \
+    {                                                             \
+        TX_P##n = q##_B##n[RING_SLOT(q##_T##n, UART_TXQ_LEN)];    \
+        TX_K##n = q##_N##n[RING_SLOT(q##_T##n, UART_TXQ_LEN)];    \
+    } while (0)
+
+/*
+ * Send the next byte of port n; TX interrupt, or main with Busyn just set.
+ * The indices move before the byte goes to SBUF: from main, the TX
+ * interrupt of that byte may run before the next instruction if a higher
+ * priority interrupt delays main right after the SBUF write.
+ */
+#define UART_TX_NEXT(n, sbuf)                                      \
+    do                                                             \
+    {                                                              \
+        u8 tx_b;                                                   \
+        if (!TX_K##n && !RING_EMPTY(TX_H##n, TX_T##n))             \
+        {                                                          \
+            RING_GET(TX_u##n, TX_T##n, UART_TX_RING, tx_b);        \
+            sbuf = tx_b;                                           \
+            HAL_UART_TX(n);                                        \
+            break;                                                 \
+        }                                                          \
+        if (!TX_K##n)                                              \
+        {                                                          \
+            if (TX_C##n || (RING_EMPTY(TQ_H##n, TQ_T##n) &&        \
+                            RING_EMPTY(TL_H##n, TL_T##n)))         \
+            {                                                      \
+                Busy##n = 0;                                       \
+                if (!TX_C##n)                                      \
+                {                                                  \
+                    UART_TR_OFF##n                                 \
+                }                                                  \
+                break;                                             \
+            }                                                      \
+            TX_L##n = RING_EMPTY(TQ_H##n, TQ_T##n);                \
+            if (TX_L##n)                                           \
+                UART_BQ_START(TL, n);                              \
+            else                                                   \
+                UART_BQ_START(TQ, n);                              \
+            UART_TR_ON##n                                          \
+        }                                                          \
+        tx_b = *TX_P##n;                                           \
+        TX_P##n++;                                                 \
+        if (!--TX_K##n)                                            \
+        {                                                          \
+            if (TX_L##n)                                           \
+                TL_T##n++;                                         \
+            else                                                   \
+                TQ_T##n++;                                         \
+        }                                                          \
+        sbuf = tx_b;                                               \
+        HAL_UART_TX(n);                                            \
+    } while (0)
+
+/* Start the transmitter of port n if it is idle (main) */
+#define UART_TX_KICK(n, sbuf)         \
+    do                                \
+    {                                 \
+        if (!Busy##n)                 \
+        {                             \
+            Busy##n = 1;              \
+            UART_TX_NEXT(n, sbuf);    \
+        }                             \
+    } while (0)
+
+/* Return the blocks queue q of port n is done with to the pool (main) */
+#define UART_BQ_RECLAIM(q, n)                                       \
+    do                                                              \
+    {                                                               \
+        while (q##_R##n != q##_T##n)                                \
+        {                                                           \
+            Pool_Free(q##_B##n[RING_SLOT(q##_R##n, UART_TXQ_LEN)]); \
+            q##_R##n++;                                             \
+        }                                                           \
+    } while (0)
+
+#define UART_TQ_RECLAIM(n)     \
+    do                         \
+    {                          \
+        UART_BQ_RECLAIM(TQ, n); \
+        UART_BQ_RECLAIM(TL, n); \
+    } while (0)
+
+/* Queue a block on queue q of port n, or return 0 from the caller when it is full */
+#define UART_BQ_PUT(q, n, sbuf, blk, len)                           \
+    do                                                              \
+    {                                                               \
+        UART_BQ_RECLAIM(q, n);                                      \
+        if (RING_FULL(q##_H##n, q##_R##n, UART_TXQ_LEN))            \
+            return 0;                                               \
+        q##_B##n[RING_SLOT(q##_H##n, UART_TXQ_LEN)] = (blk);        \
+        q##_N##n[RING_SLOT(q##_H##n, UART_TXQ_LEN)] = (len);        \
+        q##_H##n++;                                                 \
+        UART_TX_KICK(n, sbuf);                                      \
+    } while (0)
+
+/* Queue on the class prio (UART_TX_HIGH / UART_TX_LOW) of port n */
+#define UART_TQ_PUT(n, sbuf, blk, len, prio)          \
+    do                                                \
+    {                                                 \
+        if (prio == UART_TX_LOW)                      \
+            UART_BQ_PUT(TL, n, sbuf, blk, len);       \
+        else                                          \
+            UART_BQ_PUT(TQ, n, sbuf, blk, len);       \
+    } while (0)
+
+/* Frame being collected per port (main only), index uart - 2 */
+static __xdata u8 *__xdata rx_blk[4];
+static __xdata u16 rx_len[4];
 #if UART2_ENABLE
-u8 __xdata R_u2[UART2_RX_LENTH];
-volatile u8 __xdata R_OD2 = 0;  // Receive data flag
-volatile u16 __xdata R_CN2 = 0; // Receive data count
-volatile u8 __xdata T_O2 = 0;   // Receive data timeout
-volatile __bit Busy2 = 0;       // Transmit busy flag
+__xdata u8 *MEM_HOT R_u2;            // RX ring, one pool block (Uart_Init)
+volatile MEM_HOT u8 R_H2 = 0;         // RX ring head (ISR)
+volatile MEM_HOT u8 R_T2 = 0;         // RX ring tail (main)
+volatile MEM_HOT u8 T_O2 = 0;         // Receive data timeout
+static __xdata u8 TX_u2[UART_TX_RING]; // TX ring
+volatile MEM_HOT u8 TX_H2 = 0;        // TX ring head (main)
+volatile MEM_HOT u8 TX_T2 = 0;        // TX ring tail (ISR)
+static __xdata u8 *__xdata TQ_B2[UART_TXQ_LEN]; // TX block queue, UART_TX_HIGH
+static __xdata u16 TQ_N2[UART_TXQ_LEN];         // and the block lengths
+volatile MEM_WARM u8 TQ_H2 = 0;                 // TX block queue head (main)
+volatile MEM_WARM u8 TQ_T2 = 0;                 // TX block queue tail (ISR, block sent)
+static __xdata u8 TQ_R2 = 0;                    // blocks returned to the pool (main)
+static __xdata u8 *__xdata TL_B2[UART_TXQ_LEN]; // TX block queue, UART_TX_LOW
+static __xdata u16 TL_N2[UART_TXQ_LEN];
+volatile MEM_WARM u8 TL_H2 = 0;
+volatile MEM_WARM u8 TL_T2 = 0;
+static __xdata u8 TL_R2 = 0;
+__xdata u8 *MEM_WARM TX_P2;                     // block being sent (ISR)
+MEM_WARM u16 TX_K2 = 0;                         // bytes of it left (ISR)
+volatile __bit Busy2 = 0;             // Transmitter running
+volatile __bit TX_C2 = 0;             // Main is composing a frame in the TX ring
+__bit TX_L2 = 0;                      // Block being sent is from TL_*
 #endif
 
 #if UART3_ENABLE
-u8 __xdata R_u3[UART3_RX_LENTH];
-volatile u8 __xdata R_OD3 = 0;  // Receive data flag
-volatile u16 __xdata R_CN3 = 0; // Receive data count
-volatile u8 __xdata T_O3 = 0;   // Receive data timeout
-volatile __bit Busy3 = 0;       // Transmit busy flag
+__xdata u8 *MEM_HOT R_u3;            // RX ring, one pool block (Uart_Init)
+volatile MEM_HOT u8 R_H3 = 0;         // RX ring head (ISR)
+volatile MEM_HOT u8 R_T3 = 0;         // RX ring tail (main)
+volatile MEM_HOT u8 T_O3 = 0;         // Receive data timeout
+static __xdata u8 TX_u3[UART_TX_RING]; // TX ring
+volatile MEM_HOT u8 TX_H3 = 0;        // TX ring head (main)
+volatile MEM_HOT u8 TX_T3 = 0;        // TX ring tail (ISR)
+static __xdata u8 *__xdata TQ_B3[UART_TXQ_LEN]; // TX block queue, UART_TX_HIGH
+static __xdata u16 TQ_N3[UART_TXQ_LEN];         // and the block lengths
+volatile MEM_WARM u8 TQ_H3 = 0;                 // TX block queue head (main)
+volatile MEM_WARM u8 TQ_T3 = 0;                 // TX block queue tail (ISR, block sent)
+static __xdata u8 TQ_R3 = 0;                    // blocks returned to the pool (main)
+static __xdata u8 *__xdata TL_B3[UART_TXQ_LEN]; // TX block queue, UART_TX_LOW
+static __xdata u16 TL_N3[UART_TXQ_LEN];
+volatile MEM_WARM u8 TL_H3 = 0;
+volatile MEM_WARM u8 TL_T3 = 0;
+static __xdata u8 TL_R3 = 0;
+__xdata u8 *MEM_WARM TX_P3;                     // block being sent (ISR)
+MEM_WARM u16 TX_K3 = 0;                         // bytes of it left (ISR)
+volatile __bit Busy3 = 0;             // Transmitter running
+volatile __bit TX_C3 = 0;             // Main is composing a frame in the TX ring
+__bit TX_L3 = 0;                      // Block being sent is from TL_*
 #endif
 
 #if UART4_ENABLE
-u8 __xdata R_u4[UART4_RX_LENTH];
-volatile u8 __xdata R_OD4 = 0;  // Receive data flag
-volatile u16 __xdata R_CN4 = 0; // Receive data count
-volatile u8 __xdata T_O4 = 0;   // Receive data timeout
-volatile __bit Busy4 = 0;       // Transmit busy flag
+__xdata u8 *MEM_HOT R_u4;            // RX ring, one pool block (Uart_Init)
+volatile MEM_HOT u8 R_H4 = 0;         // RX ring head (ISR)
+volatile MEM_HOT u8 R_T4 = 0;         // RX ring tail (main)
+volatile MEM_HOT u8 T_O4 = 0;         // Receive data timeout
+static __xdata u8 TX_u4[UART_TX_RING]; // TX ring
+volatile MEM_HOT u8 TX_H4 = 0;        // TX ring head (main)
+volatile MEM_HOT u8 TX_T4 = 0;        // TX ring tail (ISR)
+static __xdata u8 *__xdata TQ_B4[UART_TXQ_LEN]; // TX block queue, UART_TX_HIGH
+static __xdata u16 TQ_N4[UART_TXQ_LEN];         // and the block lengths
+volatile MEM_WARM u8 TQ_H4 = 0;                 // TX block queue head (main)
+volatile MEM_WARM u8 TQ_T4 = 0;                 // TX block queue tail (ISR, block sent)
+static __xdata u8 TQ_R4 = 0;                    // blocks returned to the pool (main)
+static __xdata u8 *__xdata TL_B4[UART_TXQ_LEN]; // TX block queue, UART_TX_LOW
+static __xdata u16 TL_N4[UART_TXQ_LEN];
+volatile MEM_WARM u8 TL_H4 = 0;
+volatile MEM_WARM u8 TL_T4 = 0;
+static __xdata u8 TL_R4 = 0;
+__xdata u8 *MEM_WARM TX_P4;                     // block being sent (ISR)
+MEM_WARM u16 TX_K4 = 0;                         // bytes of it left (ISR)
+volatile __bit Busy4 = 0;             // Transmitter running
+volatile __bit TX_C4 = 0;             // Main is composing a frame in the TX ring
+__bit TX_L4 = 0;                      // Block being sent is from TL_*
+#if UART4_NODE
+MEM_HOT u8 N_S4 = NODE_HUNT;         // node filter state (ISR)
+MEM_HOT u8 N_K4 = 0;                 // node filter byte count (ISR)
+#endif
 #endif
 
 #if UART5_ENABLE
-u8 __xdata R_u5[UART5_RX_LENTH];
-volatile u8 __xdata R_OD5 = 0;  // Receive data flag
-volatile u16 __xdata R_CN5 = 0; // Receive data count
-volatile u8 __xdata T_O5 = 0;   // Receive data timeout
-volatile __bit Busy5 = 0;       // Transmit busy flag
+__xdata u8 *MEM_HOT R_u5;            // RX ring, one pool block (Uart_Init)
+volatile MEM_HOT u8 R_H5 = 0;         // RX ring head (ISR)
+volatile MEM_HOT u8 R_T5 = 0;         // RX ring tail (main)
+volatile MEM_HOT u8 T_O5 = 0;         // Receive data timeout
+static __xdata u8 TX_u5[UART_TX_RING]; // TX ring
+volatile MEM_HOT u8 TX_H5 = 0;        // TX ring head (main)
+volatile MEM_HOT u8 TX_T5 = 0;        // TX ring tail (ISR)
+static __xdata u8 *__xdata TQ_B5[UART_TXQ_LEN]; // TX block queue, UART_TX_HIGH
+static __xdata u16 TQ_N5[UART_TXQ_LEN];         // and the block lengths
+volatile MEM_WARM u8 TQ_H5 = 0;                 // TX block queue head (main)
+volatile MEM_WARM u8 TQ_T5 = 0;                 // TX block queue tail (ISR, block sent)
+static __xdata u8 TQ_R5 = 0;                    // blocks returned to the pool (main)
+static __xdata u8 *__xdata TL_B5[UART_TXQ_LEN]; // TX block queue, UART_TX_LOW
+static __xdata u16 TL_N5[UART_TXQ_LEN];
+volatile MEM_WARM u8 TL_H5 = 0;
+volatile MEM_WARM u8 TL_T5 = 0;
+static __xdata u8 TL_R5 = 0;
+__xdata u8 *MEM_WARM TX_P5;                     // block being sent (ISR)
+MEM_WARM u16 TX_K5 = 0;                         // bytes of it left (ISR)
+volatile __bit Busy5 = 0;             // Transmitter running
+volatile __bit TX_C5 = 0;             // Main is composing a frame in the TX ring
+__bit TX_L5 = 0;                      // Block being sent is from TL_*
+#if UART5_NODE
+MEM_HOT u8 N_S5 = NODE_HUNT;         // node filter state (ISR)
+MEM_HOT u8 N_K5 = 0;                 // node filter byte count (ISR)
+#endif
 #endif
 
 /**
@@ -68,10 +377,9 @@ void Uart_Init(void)
         ADCON = 0x80;          // Select SREL0H:L as the baud rate generator
         SCON2 = 0x50;          // Accept enable and mode settings
         PCON &= 0x7F;          // SMOD=0
+        R_u2 = Pool_Alloc(POOL_OWNER_UART(2));
         IEN0 |= 0X10;          // ES0=1 Serial port 2 receiving + sending interrupt
         EA = 1;
-        R_OD2 = 0;
-        R_CN2 = 0;
     }
 #endif
 
@@ -84,6 +392,7 @@ void Uart_Init(void)
         P0MDOUT |= 0x40; // P0.6 TXD push-pull
         SCON3 = 0x90;    // Enable RX, mode settings
         IEN2 |= 0x01;    // UART3 interrupt enable
+        R_u3 = Pool_Alloc(POOL_OWNER_UART(3));
         EA = 1;
     }
 #endif
@@ -98,6 +407,7 @@ void Uart_Init(void)
         ES4R = 1;      // RX interrupt enable
         ES4T = 1;      // TX interrupt enable (kept off in polling TX path)
         TR4 = 0;
+        R_u4 = Pool_Alloc(POOL_OWNER_UART(4));
         EA = 1;
     }
 #endif
@@ -113,65 +423,70 @@ void Uart_Init(void)
         ES5R = 1;            // RX interrupt enable
         ES5T = 1;            // TX interrupt enable (kept off in polling TX path)
         TR5 = 0;
+        R_u5 = Pool_Alloc(POOL_OWNER_UART(5));
         EA = 1;
     }
 #endif
 }
 
+/*
+ * RX ISRs run in register bank IRQ_BANK_RX (no R0-R7 save/restore) at the
+ * level set by IRQ_PRIO_Gx. They must not call functions.
+ */
+
 // UART2 ISR
-void uart2_ISR(void) __interrupt(4)
+void uart2_ISR(void) __interrupt(4) IRQ_USING_RX
 {
 #if UART2_ENABLE
+    PROF_ISR_BEGIN(PROF_ISR_UART2);
     if (RI2) // receive interrupt
     {
-        R_u2[R_CN2] = SBUF2; // store data
-        SCON2 &= 0xFE;       // clear RI2
-        R_OD2 = 1;           // set flag
-        if (R_CN2 < UART2_RX_LENTH - 1)
-            R_CN2++;
-        T_O2 = 5; // timeout reload
+        UART_RX_PUT(2, SBUF2);                         // store data, dropped when full
+        SCON2 &= 0xFE;                                 // clear RI2
+        T_O2 = UART_T_O(UART2_PROTO, BAUD_UART2);      // timeout reload
     }
     if (TI2 == 1)
     {
         SCON2 &= 0xFD;
-        Busy2 = 0;
+        UART_TX_NEXT(2, SBUF2); // next queued byte or block
     }
+    PROF_ISR_END(PROF_ISR_UART2);
 #endif
 }
 
 // UART3 ISR
-void uart3_ISR(void) __interrupt(16)
+void uart3_ISR(void) __interrupt(16) IRQ_USING_RX
 {
 #if UART3_ENABLE
+    PROF_ISR_BEGIN(PROF_ISR_UART3);
     if (SCON3 & 0x01)
     {
-        R_u3[R_CN3] = SBUF3;
+        UART_RX_PUT(3, SBUF3);
         SCON3 &= 0xFE;
-        //				        SCON3&=0xFE;
-        R_OD3 = 1;
-        if (R_CN3 < UART3_RX_LENTH - 1)
-            R_CN3++;
-        T_O3 = 5;
+        T_O3 = UART_T_O(UART3_PROTO, BAUD_UART3);
     }
     if (SCON3 & 0x02)
     {
         SCON3 &= 0xFD;
-        SCON3 &= 0xFD;
-        Busy3 = 0;
+        UART_TX_NEXT(3, SBUF3);
     }
+    PROF_ISR_END(PROF_ISR_UART3);
 #endif
 }
 
 // UART4 receive ISR
-void uart4_RISR(void) __interrupt(11)
+void uart4_RISR(void) __interrupt(11) IRQ_USING_RX
 {
 #if UART4_ENABLE
-    R_u4[R_CN4] = SBUF4_RX;
+    PROF_ISR_BEGIN(PROF_ISR_UART4_RX);
+#if UART4_NODE
+    UART_NODE_RX(4, SBUF4_RX);
+#else
+    UART_RX_PUT(4, SBUF4_RX);
+#endif
     SCON4R &= 0xFE;
-    R_OD4 = 1;
-    if (R_CN4 < UART4_RX_LENTH - 1)
-        R_CN4++;
-    T_O4 = 5;
+    T_O4 = UART_T_O(UART4_PROTO, BAUD_UART4);
+    PROF_ISR_END(PROF_ISR_UART4_RX);
 #endif
 }
 
@@ -179,40 +494,49 @@ void uart4_RISR(void) __interrupt(11)
 void uart4_TISR(void) __interrupt(10)
 {
 #if UART4_ENABLE
+    PROF_ISR_BEGIN(PROF_ISR_UART4_TX);
     SCON4T &= 0xFE;
-    Busy4 = 0;
+    UART_TX_NEXT(4, SBUF4_TX); // drops TR4 once idle
+    PROF_ISR_END(PROF_ISR_UART4_TX);
 #endif
 }
 
 // UART5 receive ISR
-void uart5_RISR(void) __interrupt(13)
+void uart5_RISR(void) __interrupt(13) IRQ_USING_RX
 {
 #if UART5_ENABLE
+    PROF_ISR_BEGIN(PROF_ISR_UART5_RX);
     if (RI5) // receive flag
     {
-        R_u5[R_CN5] = SBUF5_RX;
-        SCON5R &= 0xFE;                 // clear receive flag
-        R_OD5 = 1;                      // receive data flag
-        if (R_CN5 < UART5_RX_LENTH - 1) // prevent overflow
-            R_CN5++;                    // increase receive count
-        T_O5 = 5;                       // set receive timeout
+#if UART5_NODE
+        UART_NODE_RX(5, SBUF5_RX);
+#else
+        UART_RX_PUT(5, SBUF5_RX); // full: byte dropped
+#endif
+        SCON5R &= 0xFE; // clear receive flag
+        T_O5 = UART_T_O(UART5_PROTO, BAUD_UART5); // set receive timeout
     }
+    PROF_ISR_END(PROF_ISR_UART5_RX);
 #endif
 }
 // UART5 transmit ISR
 void uart5_TISR(void) __interrupt(12)
 {
 #if UART5_ENABLE
+    PROF_ISR_BEGIN(PROF_ISR_UART5_TX);
     SCON5T &= 0xFE;
-    Busy5 = 0;
+    UART_TX_NEXT(5, SBUF5_TX); // drops TR5 once idle
+    PROF_ISR_END(PROF_ISR_UART5_TX);
 #endif
 }
 
 /**
  * @brief Send a single byte over the specified UART.
  *
- * This function waits until the UART is not busy, then writes the byte to the
- * appropriate SBUF register to initiate transmission.
+ * The byte is queued in the port's TX ring and sent by the TX interrupt.
+ * This function waits only while the ring is full. With the transmitter
+ * idle no TX interrupt can come, so the first byte is started here. A queued
+ * block being sent is finished first.
  *
  * @param Uart_number UART channel number (2, 3, 4, or 5)
  * @param Dat         Byte to send
@@ -222,37 +546,37 @@ void uart_send_byte(u8 Uart_number, u8 Dat)
     if (Uart_number == 2)
     {
 #if UART2_ENABLE
-        while (Busy2)
+        while (RING_FULL(TX_H2, TX_T2, UART_TX_RING))
             ;
-        Busy2 = 1;
-        SBUF2 = Dat;
+        RING_PUT(TX_u2, TX_H2, UART_TX_RING, Dat);
+        UART_TX_KICK(2, SBUF2);
 #endif
     }
     else if (Uart_number == 3)
     {
 #if UART3_ENABLE
-        while (Busy3)
+        while (RING_FULL(TX_H3, TX_T3, UART_TX_RING))
             ;
-        Busy3 = 1;
-        SBUF3 = Dat;
+        RING_PUT(TX_u3, TX_H3, UART_TX_RING, Dat);
+        UART_TX_KICK(3, SBUF3);
 #endif
     }
     else if (Uart_number == 4)
     {
 #if UART4_ENABLE
-        while (Busy4)
+        while (RING_FULL(TX_H4, TX_T4, UART_TX_RING))
             ;
-        Busy4 = 1;
-        SBUF4_TX = Dat;
+        RING_PUT(TX_u4, TX_H4, UART_TX_RING, Dat);
+        UART_TX_KICK(4, SBUF4_TX);
 #endif
     }
     else if (Uart_number == 5)
     {
 #if UART5_ENABLE
-        while (Busy5)
+        while (RING_FULL(TX_H5, TX_T5, UART_TX_RING))
             ;
-        Busy5 = 1;
-        SBUF5_TX = Dat;
+        RING_PUT(TX_u5, TX_H5, UART_TX_RING, Dat);
+        UART_TX_KICK(5, SBUF5_TX);
 #endif
     }
 }
@@ -330,24 +654,135 @@ void uart_send_word(u8 Uart_number, u16 data)
     uart_4_5_pin_ctrl(Uart_number, 0);
 }
 
+/**
+ * @brief Send a DGUS frame (5A A5 LEN ...) as one RS485 transmission.
+ *
+ * On an addressed port (UART4_NODE / UART5_NODE) the node ID is inserted
+ * after the header, so the host can tell which panel answered.
+ *
+ * @param uart  UART channel number (2, 3, 4, or 5)
+ * @param frame Frame starting with 5A A5 LEN, CRC already appended if used
+ * @param len   Frame length in bytes (LEN + 3)
+ */
+void uart_send_frame(u8 uart, const u8 *frame, u16 len)
+{
+    u8 node = UART_NODE(uart);
+    u16 i;
+
+    uart_4_5_pin_ctrl(uart, 1);
+    for (i = 0; i < len; i++)
+    {
+        uart_send_byte(uart, frame[i]);
+        if (i == 1 && node)
+            uart_send_byte(uart, node);
+    }
+    uart_4_5_pin_ctrl(uart, 0);
+}
+
+/**
+ * @brief Queue a pool block for sending as it is, without copying it.
+ *
+ * The transmitter sends it at a frame boundary of the port, after what main
+ * composed in the TX ring and, for UART_TX_LOW, after every UART_TX_HIGH
+ * block. The driver returns it to the pool once it is out, so the caller
+ * must not touch it after a successful call.
+ *
+ * @param uart UART channel number (2, 3, 4, or 5)
+ * @param blk  Block from Pool_Alloc()
+ * @param len  Bytes to send from the start of the block, 1..POOL_BLOCK_SIZE
+ * @param prio UART_TX_HIGH (routed frames, Modbus answers) or UART_TX_LOW
+ *             (auto-uploads)
+ * @return 1 if queued, 0 if that queue (UART_TXQ_LEN) is full: the block
+ *         still belongs to the caller
+ */
+u8 uart_send_block(u8 uart, __xdata u8 *blk, u16 len, u8 prio)
+{
+    if (!len)
+        return 0;
+#if UART2_ENABLE
+    if (uart == 2)
+    {
+        UART_TQ_PUT(2, SBUF2, blk, len, prio);
+        return 1;
+    }
+#endif
+#if UART3_ENABLE
+    if (uart == 3)
+    {
+        UART_TQ_PUT(3, SBUF3, blk, len, prio);
+        return 1;
+    }
+#endif
+#if UART4_ENABLE
+    if (uart == 4)
+    {
+        UART_TQ_PUT(4, SBUF4_TX, blk, len, prio);
+        return 1;
+    }
+#endif
+#if UART5_ENABLE
+    if (uart == 5)
+    {
+        UART_TQ_PUT(5, SBUF5_TX, blk, len, prio);
+        return 1;
+    }
+#endif
+    return 0;
+}
+
+/* Return every block the transmitters have sent to the pool */
+static void uart_tx_reclaim(void)
+{
+#if UART2_ENABLE
+    UART_TQ_RECLAIM(2);
+#endif
+#if UART3_ENABLE
+    UART_TQ_RECLAIM(3);
+#endif
+#if UART4_ENABLE
+    UART_TQ_RECLAIM(4);
+#endif
+#if UART5_ENABLE
+    UART_TQ_RECLAIM(5);
+#endif
+}
+
+/* Queue the shared upload packet on one port at the low TX class */
+static void uart_upload(u8 uart, __xdata u8 *packet)
+{
+    Pool_Hold(packet);
+    if (!uart_send_block(uart, packet, (u16)packet[2] + 3u, UART_TX_LOW))
+        Pool_Free(packet); // queue full: this port misses the update
+}
+
 /**
  * @brief Monitor DGUS variable change flag and send updated data over UART.
  *
  * This function continuously checks DGUS system registers (0x0F00, 0x0F01) for variable
  * change events. When a change is detected, it reads the updated data from DGUS RAM,
- * formats it into a communication packet (5A A5 protocol frame), and sends it through
- * all enabled UART channels. After transmission, it clears the DGUS update flags.
+ * formats it into a communication packet (5A A5 protocol frame), and queues it on
+ * all enabled UART channels. After that, it clears the DGUS update flags.
  *
  * @note
  *  - Packet format: [5A A5 | Length | 0x83 | Address_H | Address_L | Data...]
- *  - UART channels are conditionally compiled with `UARTx_ENABLE`.
- *  - Clears DGUS registers 0x0F00 and 0x0F01 after sending.
+ *  - UART channels are conditionally compiled with `UARTx_ENABLE`. Modbus
+ *    ports and addressed RS485 ports (UARTx_NODE) get no uploads: only the
+ *    host may start a transmission on a multi-drop bus. Neither do ports
+ *    carrying a raw bridge (route_list.txt), whose byte stream has no
+ *    frame boundary to put them at.
+ *  - The packet is one pool block queued on every port at UART_TX_LOW, so
+ *    ACKs and 0x83 replies overtake it at the next frame boundary and the
+ *    monitor does not wait for the wire. The block is free again after the
+ *    slowest port has sent it; until then the next period finds the pool
+ *    quota (POOL_QUOTA_MON) used and retries, so updates coalesce in the
+ *    DGUS flags instead of piling up in the queues.
+ *  - Clears DGUS registers 0x0F00 and 0x0F01 after queuing. A change of
+ *    more than DGUS_READ_WORDS_MAX words is sent in parts: the flags are
+ *    advanced past the words sent, and the next period sends the rest.
+ *  - Runs as a scheduler task every MONITOR_PERIOD_MS (see main.c).
  */
 void DGUS_MonitorAndSendUpdates(void)
 {
-    if (monitor_ms < 100)
-        return;
-    monitor_ms = 0;
     u16 change_flag = DGUS_Read_VP(0x0F00); // Variable change indication
     u16 var_length = DGUS_Read_VP(0x0F01);  // Variable length
     u16 last_addr = 0;
@@ -356,32 +791,38 @@ void DGUS_MonitorAndSendUpdates(void)
     if (((u8)(change_flag >> 8)) == 0x5A)
     {
         u8 i = 0;
+        u8 words = (u8)var_length;
         u16 temp_val = 0;
-        static __xdata u8 packet[100] = {0};
+        __xdata u8 *packet;
+
+        uart_tx_reclaim(); // the last packet may just have gone out
+        packet = Pool_Alloc(POOL_OWNER_MON);
+
+        if (!packet)
+            return; // flags left set: retried next period
 
         // Build packet header
         // Format (DGUS 0x83 response-like):
         // [5A A5 | LEN | 0x83 | AddrH | AddrL | Words | Data(2*Words) | (CRC Lo | CRC Hi if CRC ON)]
         packet[0] = 0x5A;
         packet[1] = 0xA5;
-        {
-            u8 words = (u8)var_length;                // var_length low-byte = number of words
-            packet[2] = (u8)(2u * words + 4u);        // LEN (without CRC) = 4 + 2*Words
-        }
         packet[3] = 0x83;
         packet[4] = (u8)change_flag;       // AddrH (0x0F00 high-byte==0x5A, low-byte carries AddrH)
         packet[5] = (u8)(var_length >> 8); // AddrL (0x0F01 high-byte)
         packet[6] = (u8)var_length;        // Words  (0x0F01 low-byte)
+        if (packet[6] > DGUS_READ_WORDS_MAX)
+            packet[6] = DGUS_READ_WORDS_MAX; // the rest would run past the block
+        packet[2] = (u8)(2u * packet[6] + 4u); // LEN (without CRC) = 4 + 2*Words
 
         last_addr = ((u16)packet[4] << 8) | packet[5];
-        /* Check Flags */
-        Flags_SetByVP(last_addr);
         // Read variable data from DGUS and append to packet
-        for (i = 0; i < (u8)var_length; i++)
+        for (i = 0; i < packet[6]; i++)
         {
             temp_val = DGUS_Read_VP(last_addr + i);
             packet[7 + 2 * i] = (u8)(temp_val >> 8);
             packet[8 + 2 * i] = (u8)(temp_val);
+            /* Check Flags (one event per changed word) */
+            Flags_SetByVP(last_addr + i, temp_val);
         }
 
 #if USE_CRC
@@ -394,32 +835,31 @@ void DGUS_MonitorAndSendUpdates(void)
         }
 #endif
 
-        // Send packet over enabled UART channels (send exactly LEN+3 bytes; do not append CRC here)
-#if UART2_ENABLE
-        uart_4_5_pin_ctrl(2, 1);
-        for (u16 i = 0; i < (u16)packet[2] + 3u; i++)
-            uart_send_byte(2, packet[i]);
-        uart_4_5_pin_ctrl(2, 0);
+        // Queue the packet on the enabled UART channels (exactly LEN+3 bytes; CRC already in place)
+#if UART2_ENABLE && UART2_PROTO == UART_PROTO_DGUS && !ROUTE_RAW_IN2
+        uart_upload(2, packet);
 #endif
-#if UART3_ENABLE
-        uart_4_5_pin_ctrl(3, 1);
-        for (u16 i = 0; i < (u16)packet[2] + 3u; i++)
-            uart_send_byte(3, packet[i]);
-        uart_4_5_pin_ctrl(3, 0);
+#if UART3_ENABLE && UART3_PROTO == UART_PROTO_DGUS && !ROUTE_RAW_IN3
+        uart_upload(3, packet);
 #endif
-#if UART4_ENABLE
-        uart_4_5_pin_ctrl(4, 1);
-        for (u16 i = 0; i < (u16)packet[2] + 3u; i++)
-            uart_send_byte(4, packet[i]);
-        uart_4_5_pin_ctrl(4, 0);
+#if UART4_ENABLE && UART4_PROTO == UART_PROTO_DGUS && !UART4_NODE && !ROUTE_RAW_IN4
+        uart_upload(4, packet);
 #endif
-#if UART5_ENABLE
-        uart_4_5_pin_ctrl(5, 1);
-        for (u16 i = 0; i < (u16)packet[2] + 3u; i++)
-            uart_send_byte(5, packet[i]);
-        uart_4_5_pin_ctrl(5, 0);
+#if UART5_ENABLE && UART5_PROTO == UART_PROTO_DGUS && !UART5_NODE && !ROUTE_RAW_IN5
+        uart_upload(5, packet);
 #endif
 
+        Pool_Free(packet); // freed once the last port has sent it
+
+        if (words > packet[6])
+        {
+            // Advance the flags past the words sent; the rest goes next period
+            last_addr += packet[6];
+            DGUS_Write_VP(0x0F00, 0x5A00 | (last_addr >> 8));
+            DGUS_Write_VP(0x0F01, (last_addr << 8) | (u8)(words - packet[6]));
+            return;
+        }
+
         // Clear DGUS flags
         DGUS_Write_VP(0x0F00, 0);
         DGUS_Write_VP(0x0F01, 0);
@@ -436,8 +876,9 @@ void DGUS_MonitorAndSendUpdates(void)
  *
  * @param uart UART channel number (e.g., 2, 3, 4, 5)
  * @param frame Pointer to received command frame buffer
+ * @return 1 if the data was written, 0 if the frame failed its CRC check
  */
-void DGUS_HandleCmd82(u8 uart, u8 *frame)
+u8 DGUS_HandleCmd82(u8 uart, u8 *frame)
 {
     if (Crc_check_flog == 0) // --- Case 1: No CRC check ---
     {
@@ -446,11 +887,9 @@ void DGUS_HandleCmd82(u8 uart, u8 *frame)
         if (Response_flog)
         {
             const u8 ack[] = {DTHD1, DTHD2, 0x03, 0x82, 0x4F, 0x4B};
-            uart_4_5_pin_ctrl(uart, 1);
-            for (u8 i = 0; i < 6; i++)
-                uart_send_byte(uart, ack[i]);
-            uart_4_5_pin_ctrl(uart, 0);
+            uart_send_frame(uart, ack, 6);
         }
+        return 1;
     }
     else // --- Case 2: With CRC check ---
     {
@@ -471,13 +910,12 @@ void DGUS_HandleCmd82(u8 uart, u8 *frame)
                 u16 ack_crc_val = crc16table(ack_crc + 3, ack_crc[2] - 2);
                 ack_crc[ack_crc[2] + 1] = (u8)(ack_crc_val & 0xFF); // low
                 ack_crc[ack_crc[2] + 2] = (u8)(ack_crc_val >> 8);   // high
-                uart_4_5_pin_ctrl(uart, 1);
-                for (u8 i = 0; i < ack_crc[2] + 3; i++)
-                    uart_send_byte(uart, ack_crc[i]);
-                uart_4_5_pin_ctrl(uart, 0);
+                uart_send_frame(uart, ack_crc, ack_crc[2] + 3);
             }
+            return 1;
         }
     }
+    return 0;
 }
 
 /**
@@ -489,8 +927,11 @@ void DGUS_HandleCmd82(u8 uart, u8 *frame)
  *  - If CRC check is enabled, it verifies the CRC, reads the requested data,
  *    appends CRC to the response, and sends it back.
  *
+ * Requests for more than DGUS_READ_WORDS_MAX words are ignored: their answer
+ * would not fit the response block.
+ *
  * @param uart     UART channel number (e.g., 2, 3, 4, 5)
- * @param response Buffer to build the response frame
+ * @param response Buffer to build the response frame (one pool block)
  * @param request  Pointer to received request frame
  */
 void DGUS_HandleCmd83(u8 uart, u8 *response, const u8 *request)
@@ -498,6 +939,9 @@ void DGUS_HandleCmd83(u8 uart, u8 *response, const u8 *request)
     u16 addr;
     u8 words;
 
+    if (request[6] > DGUS_READ_WORDS_MAX)
+        return;
+
     if (Crc_check_flog == 0)
     { // ---- CRC OFF ----
         // İlk 7 baytı kopyala: 83, AddrH, AddrL, Words dahil
@@ -510,10 +954,7 @@ void DGUS_HandleCmd83(u8 uart, u8 *response, const u8 *request)
         DGUS_ReadBytes(addr, &response[7], words);
 
         response[2] = (u8)(2u * words + 4u); // LEN = 2*Words + 4
-        uart_4_5_pin_ctrl(uart, 1);
-        for (u16 i = 0; i < (u16)response[2] + 3u; i++)
-            uart_send_byte(uart, response[i]);
-        uart_4_5_pin_ctrl(uart, 0);
+        uart_send_frame(uart, response, (u16)response[2] + 3u);
     }
     else
     {                        // ---- CRC ON ----
@@ -540,10 +981,7 @@ void DGUS_HandleCmd83(u8 uart, u8 *response, const u8 *request)
             u16 resp_crc = crc16table(response + 3, (u16)(response[2] - 2));
             response[3 + (u16)response[2] - 2] = (u8)(resp_crc & 0xFF); // CRC LOW
             response[3 + (u16)response[2] - 1] = (u8)(resp_crc >> 8);   // CRC HIGH
-            uart_4_5_pin_ctrl(uart, 1);
-            for (u16 i = 0; i < (u16)response[2] + 3u; i++)
-                uart_send_byte(uart, response[i]);
-            uart_4_5_pin_ctrl(uart, 0);
+            uart_send_frame(uart, response, (u16)response[2] + 3u);
         }
         // if CRC mismatch: silently ignore (kept for protocol compatibility)
     }
@@ -555,6 +993,8 @@ void DGUS_HandleCmd83(u8 uart, u8 *response, const u8 *request)
  * This function scans the received buffer for valid DGUS frames (starting with 0x5A 0xA5),
  * identifies the command code (0x82 or 0x83), and dispatches to the corresponding
  * command handler. CRC and response flags are applied dynamically.
+ * On an addressed port (UARTx_NODE) the ID byte is removed in place before
+ * dispatch; broadcast frames are limited to silent 0x82 writes.
  *
  * @param rx_buf    Pointer to receive buffer
  * @param data_len  Pointer to variable holding number of received bytes
@@ -566,10 +1006,10 @@ void DGUS_ParseUartFrame(u8 *Arr, u16 *Len, u8 uart, __bit resp, __bit crc_on)
 {
     u16 N = 0;
     u16 total = *Len;
-    static __xdata u8 frame[256];  // tek frame’lik güvenli buffer
-    static __xdata u8 resp83[128]; // 83 için geçici cevap alanı
+    u8 id = UART_NODE(uart) ? 1 : 0; // node ID byte after the header
+    PROF_BEGIN(PROF_PARSE);
 
-    while (N + 3u <= total)
+    while (N + 3u + id <= total)
     {
         if (Arr[N] != DTHD1 || Arr[N + 1] != DTHD2)
         {
@@ -577,107 +1017,368 @@ void DGUS_ParseUartFrame(u8 *Arr, u16 *Len, u8 uart, __bit resp, __bit crc_on)
             continue;
         }
 
-        u8 len = Arr[N + 2];
-        u16 fbytes = (u16)len + 3u;
-        if (fbytes > sizeof(frame))
-            break; // too large: safety cutoff
+        u8 len = Arr[N + 2 + id];
+        u16 fbytes = (u16)len + 3u + id;
         if (N + fbytes > total)
             break; // incomplete frame: try later
 
-        for (u16 i = 0; i < fbytes; i++)
-            frame[i] = Arr[N + i];
+        u8 *frame = Arr + N; // in place, the frame block belongs to main
+        __bit bcast = 0;
 
-        Response_flog = resp;
+        if (id)
+        {
+            // 5A A5 ID LEN ... -> 5A A5 LEN ... one byte later
+            bcast = (Arr[N + 2] == UART_NODE_ALL);
+            frame++;
+            frame[0] = DTHD1;
+            frame[1] = DTHD2;
+            if (bcast && frame[3] != 0x82)
+            {
+                N += fbytes; // nobody may answer a broadcast
+                continue;
+            }
+        }
+
+        Response_flog = resp && !bcast;
         Crc_check_flog = crc_on;
 
         u16 addr = (u16)frame[4] << 8 | frame[5];
-        Flags_SetByUart(addr);
         if (frame[3] == 0x82)
         {
-            DGUS_HandleCmd82(uart, frame);
+            // Flag/event per written word, only for a write that passed its CRC:
+            // LEN = cmd(1) + addr(2) + data (+ CRC(2))
+            u8 overhead = crc_on ? 5u : 3u;
+            u8 words = (len > overhead) ? (u8)((len - overhead) >> 1) : 0;
+            if (DGUS_HandleCmd82(uart, frame))
+                for (u8 w = 0; w < words; w++)
+                    Flags_SetByUart(uart, 0x82, addr + w, (u16)frame[6 + 2 * w] << 8 | frame[7 + 2 * w]);
         }
         else if (frame[3] == 0x83)
         {
-            DGUS_HandleCmd83(uart, resp83, frame);
+            __xdata u8 *resp83 = Pool_Alloc(POOL_OWNER_UART(uart));
+
+            Flags_SetByUart(uart, 0x83, addr, frame[6]); // value = requested words
+            if (resp83)
+            {
+                DGUS_HandleCmd83(uart, resp83, frame);
+                Pool_Free(resp83);
+            }
+            else
+                dgus_reply_drops++; // no block: the host sees a timeout
+        }
+#if PROFILE_ENABLE
+        else if (frame[3] == PROF_CMD)
+        {
+            if (frame[4] == 0x01)
+                Prof_Reset();
+            else
+                Prof_Dump(uart, crc_on);
         }
+#endif
         N += fbytes;
     }
+    PROF_END(PROF_PARSE);
+}
+
+#if ROUTE_COUNT
+/**
+ * @brief Send a finished frame on through the first matching route.
+ *
+ * The frame block itself goes to the target's TX queue, so forwarding costs
+ * the table scan and no copy. A full target queue drops the frame; the
+ * sender's retry covers it, as for a lost frame.
+ *
+ * @return 1 if a route took the frame (the block is no longer the caller's),
+ *         0 to handle it locally
+ */
+static u8 uart_route(u8 uart, __xdata u8 *blk, u16 len)
+{
+    u8 r;
+
+    for (r = 0; r < ROUTE_COUNT; r++)
+    {
+        u8 off = Route_Off[r];
+
+        if (Route_From[r] != uart)
+            continue;
+        if (off != ROUTE_ANY && (off >= len || blk[off] != Route_Val[r]))
+            continue;
+        if (uart_send_block(Route_To[r], blk, len, UART_TX_HIGH))
+            route_frames++;
+        else
+        {
+            route_drops++;
+            Pool_Free(blk);
+        }
+        return 1;
+    }
+    return 0;
+}
+#endif
+
+#if ROUTE_RAW2 || ROUTE_RAW3 || ROUTE_RAW4 || ROUTE_RAW5
+/* Free bytes in the TX ring of a port */
+static u16 uart_tx_room(u8 uart)
+{
+    u8 used = 0;
+
+#if UART2_ENABLE
+    if (uart == 2)
+        used = RING_COUNT(TX_H2, TX_T2);
+#endif
+#if UART3_ENABLE
+    if (uart == 3)
+        used = RING_COUNT(TX_H3, TX_T3);
+#endif
+#if UART4_ENABLE
+    if (uart == 4)
+        used = RING_COUNT(TX_H4, TX_T4);
+#endif
+#if UART5_ENABLE
+    if (uart == 5)
+        used = RING_COUNT(TX_H5, TX_T5);
+#endif
+    return RING_CAP(UART_TX_RING) - used;
+}
+
+/**
+ * @brief Raw bridge: move what the RX ISR queued straight into the TX ring
+ *        of the target port, as much as fits now. The rest waits in the RX
+ *        ring, so a slower target never blocks the main loop.
+ */
+static void uart_rx_bridge(u8 to, __xdata u8 *ring, u8 head, volatile MEM_HOT u8 *tail)
+{
+    u8 t = *tail;
+    u16 room = uart_tx_room(to);
+    u8 b;
+
+    if (RING_EMPTY(head, t) || !room)
+        return;
+    uart_4_5_pin_ctrl(to, 1);
+    while (!RING_EMPTY(head, t) && room--)
+    {
+        RING_GET(ring, t, UART_RX_RING, b);
+        uart_send_byte(to, b);
+    }
+    *tail = t;
+    uart_4_5_release(to);
+}
+#endif
+
+/**
+ * @brief Move what the RX ISR queued into the port's frame block, and parse
+ *        the block once the line has been quiet for the inter-byte timeout.
+ *
+ * The frame block is taken from the pool when the first byte arrives and
+ * returned after parsing, or handed to the target port when a route takes
+ * the frame. If the pool is empty the bytes wait in the ring.
+ *
+ * @param head     RX ring head, read before timeout
+ * @param tail     RX ring tail of the port (released here)
+ * @param timeout  T_Ox, read after head: 0 means every byte up to head is
+ *                 part of the finished frame
+ * @param proto    UARTx_PROTO: DGUS parser, Modbus RTU slave or master
+ */
+static void uart_rx_service(u8 uart, __xdata u8 *ring, u8 head, volatile MEM_HOT u8 *tail,
+                            u8 timeout, u8 proto, __bit resp)
+{
+    u8 i = uart - 2;
+    u8 t = *tail;
+    __xdata u8 *blk = rx_blk[i];
+    u16 len = rx_len[i];
+    u8 b;
+
+    if (!RING_EMPTY(head, t))
+    {
+        if (!blk)
+        {
+            blk = Pool_Alloc(POOL_OWNER_UART(uart));
+            if (!blk)
+                return;
+            rx_blk[i] = blk;
+        }
+        while (!RING_EMPTY(head, t))
+        {
+            RING_GET(ring, t, UART_RX_RING, b);
+            if (len < POOL_BLOCK_SIZE)
+                blk[len++] = b; // beyond one block: dropped
+        }
+        *tail = t;
+        rx_len[i] = len;
+    }
+
+    if (len && !timeout)
+    {
+        rx_blk[i] = 0;
+        rx_len[i] = 0;
+#if ROUTE_COUNT
+        if (uart_route(uart, blk, len))
+            return;
+#endif
+        if (proto == UART_PROTO_MB_SLAVE)
+            Modbus_SlaveFrame(uart, blk, len);
+#if MB_POLL_COUNT
+        else if (proto == UART_PROTO_MB_MASTER)
+            Modbus_MasterFrame(uart, blk, len);
+#endif
+        else
+            DGUS_ParseUartFrame(blk, &len, uart, resp, USE_CRC);
+        Pool_Free(blk);
+    }
 }
 
 /**
  * @brief Dispatch UART receive buffers for DGUS frame parsing.
  *
- * This function checks if any UART channel (2..5) has completed receiving a frame,
- * then calls DGUS_ParseUartFrame() with the proper parameters. After processing,
- * it clears the receive flags and resets the counters.
+ * Drains every enabled port's RX ring on each call, and hands a collected
+ * frame to DGUS_ParseUartFrame() once its inter-byte timeout has expired.
+ * Ports with a raw route are bridged instead. Blocks the transmitters have
+ * sent are returned to the pool first.
  */
 void DGUS_ProcessAllUarts(void)
 {
+    u8 head;
+
+    uart_tx_reclaim();
     if (g_in_download_mode)
         return;
 #if UART2_ENABLE
-    if ((R_OD2) && (!T_O2))
-    {
-        DGUS_ParseUartFrame(R_u2, (u16 *)(&R_CN2), 2, RESPONSE_UART2, USE_CRC);
-        R_OD2 = 0;
-        R_CN2 = 0;
-    }
+    head = R_H2;
+#if ROUTE_RAW2
+    uart_rx_bridge(ROUTE_RAW2, R_u2, head, &R_T2);
+#else
+    uart_rx_service(2, R_u2, head, &R_T2, T_O2, UART2_PROTO, RESPONSE_UART2);
+#endif
 #endif
 #if UART3_ENABLE
-    if ((R_OD3) && (!T_O3))
+    head = R_H3;
+#if ROUTE_RAW3
+    uart_rx_bridge(ROUTE_RAW3, R_u3, head, &R_T3);
+#else
+    uart_rx_service(3, R_u3, head, &R_T3, T_O3, UART3_PROTO, RESPONSE_UART3);
+#endif
+#endif
+#if UART4_ENABLE
+    head = R_H4;
+#if ROUTE_RAW4
+    uart_rx_bridge(ROUTE_RAW4, R_u4, head, &R_T4);
+#else
+    uart_rx_service(4, R_u4, head, &R_T4, T_O4, UART4_PROTO, RESPONSE_UART4);
+#endif
+#endif
+#if UART5_ENABLE
+    head = R_H5;
+#if ROUTE_RAW5
+    uart_rx_bridge(ROUTE_RAW5, R_u5, head, &R_T5);
+#else
+    uart_rx_service(5, R_u5, head, &R_T5, T_O5, UART5_PROTO, RESPONSE_UART5);
+#endif
+#endif
+}
+
+/**
+ * @brief Check whether DGUS_ProcessAllUarts() has work: bytes in an RX ring
+ *        or a collected frame whose inter-byte timeout has expired.
+ *        Used by the main loop before idling.
+ *
+ * @return 1 if at least one port needs service, 0 otherwise
+ */
+u8 DGUS_UartFramePending(void)
+{
+    if (g_in_download_mode)
+        return 0;
+#if UART2_ENABLE
+    if (!RING_EMPTY(R_H2, R_T2) || (rx_len[0] && !T_O2))
+        return 1;
+#endif
+#if UART3_ENABLE
+    if (!RING_EMPTY(R_H3, R_T3) || (rx_len[1] && !T_O3))
+        return 1;
+#endif
+#if UART4_ENABLE
+    if (!RING_EMPTY(R_H4, R_T4) || (rx_len[2] && !T_O4))
+        return 1;
+#endif
+#if UART5_ENABLE
+    if (!RING_EMPTY(R_H5, R_T5) || (rx_len[3] && !T_O5))
+        return 1;
+#endif
+    return 0;
+}
+
+/**
+ * @brief Start (state 1) or end (state 0) a frame composed in the TX ring.
+ *
+ * While a frame is open no queued block is put between its bytes, and on
+ * UART4/UART5 the RS485 driver (TRx) is on. Ending it does not wait: the TX
+ * interrupt releases the driver once everything queued has gone out.
+ */
+void uart_4_5_pin_ctrl(u8 uart_num, u8 state)
+{
+    if (!state)
     {
-        DGUS_ParseUartFrame(R_u3, (u16 *)(&R_CN3), 3, RESPONSE_UART3, USE_CRC);
-        R_OD3 = 0;
-        R_CN3 = 0;
+        uart_4_5_release(uart_num);
+        return;
     }
+#if UART2_ENABLE
+    if (uart_num == 2)
+        TX_C2 = 1;
+#endif
+#if UART3_ENABLE
+    if (uart_num == 3)
+        TX_C3 = 1;
 #endif
 #if UART4_ENABLE
-    if ((R_OD4 == 1) && (T_O4 == 0))
+    if (uart_num == 4)
     {
-        DGUS_ParseUartFrame(R_u4, (u16 *)(&R_CN4), 4, RESPONSE_UART4, USE_CRC);
-        R_OD4 = 0;
-        R_CN4 = 0;
+        TX_C4 = 1; // before TR4: an idle TX interrupt must not drop it again
+        TR4 = 1;
     }
 #endif
 #if UART5_ENABLE
-    if ((R_OD5 == 1) && (T_O5 == 0))
+    if (uart_num == 5)
     {
-        DGUS_ParseUartFrame(R_u5, (u16 *)(&R_CN5), 5, RESPONSE_UART5, USE_CRC);
-        R_OD5 = 0;
-        R_CN5 = 0;
+        TX_C5 = 1;
+        TR5 = 1;
     }
 #endif
 }
 
 /**
- * @brief Control the TX pins for UART4 and UART5.
+ * @brief End the frame opened by uart_4_5_pin_ctrl(n, 1) without waiting.
+ *
+ * Lets queued blocks follow. An idle transmitter is restarted here, which
+ * sends the next block or, with nothing queued, releases the RS485 driver
+ * of UART4/UART5 at once.
  */
-void uart_4_5_pin_ctrl(u8 uart_num, u8 state)
+void uart_4_5_release(u8 uart_num)
 {
+#if UART2_ENABLE
+    if (uart_num == 2)
+    {
+        TX_C2 = 0;
+        UART_TX_KICK(2, SBUF2);
+    }
+#endif
+#if UART3_ENABLE
+    if (uart_num == 3)
+    {
+        TX_C3 = 0;
+        UART_TX_KICK(3, SBUF3);
+    }
+#endif
 #if UART4_ENABLE
     if (uart_num == 4)
     {
-        if (state)
-            TR4 = 1;
-        else
-        {
-            while (Busy4)
-                ;
-            TR4 = 0;
-        }
+        TX_C4 = 0;
+        UART_TX_KICK(4, SBUF4_TX);
     }
 #endif
 #if UART5_ENABLE
     if (uart_num == 5)
     {
-        if (state)
-            TR5 = 1;
-        else
-        {
-            while (Busy5)
-                ;
-            TR5 = 0;
-        }
+        TX_C5 = 0;
+        UART_TX_KICK(5, SBUF5_TX);
     }
 #endif
-}
\ No newline at end of file
+}
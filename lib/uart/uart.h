@@ -12,35 +12,107 @@
 
 #include <stdint.h>
 #include "t5l1.h"
+#include "mem.h"
 #include "config.h"
+#include "irq.h"
 #include "crc16.h"
 #include "sys.h"
 #include "timer.h"
+#include "route_table.h"
+
+/* UARTx_PROTO values (config.h) */
+#define UART_PROTO_DGUS 0      // DGUS 5A A5 frames (0x82 / 0x83)
+#define UART_PROTO_MB_SLAVE 1  // Modbus RTU slave (lib/modbus)
+#define UART_PROTO_MB_MASTER 2 // Modbus RTU master polling src/app/mb_poll.txt (lib/modbus)
+
+/*
+ * Inter-byte timeout reload in 1 ms ticks; a frame ends once it runs out.
+ * DGUS ports keep 5. Modbus ports use the 3.5-character gap (11-bit
+ * characters), fixed at 1.75 ms above 19200 baud as the RTU spec says, plus
+ * one tick because the first tick can come right after the byte.
+ */
+#define UART_GAP_MS(baud) ((baud) > 19200 ? 2 : (u8)((38500UL + (baud) - 1) / (baud)))
+#define UART_T_O(proto, baud) ((proto) == UART_PROTO_DGUS ? 5 : UART_GAP_MS(baud) + 1)
+
+/*
+ * RS485 multi-drop (UART4_NODE / UART5_NODE): DGUS frames carry the node ID
+ * after the header, 5A A5 ID LEN CMD ... The RX ISR keeps frames for this
+ * node and broadcasts; broadcasts are applied but never answered.
+ */
+#define UART_NODE_ALL 0xFF // broadcast ID
+#define UART_NODE(u) ((u) == 4 ? UART4_NODE : (u) == 5 ? UART5_NODE : 0)
+
+/*
+ * Most words in one 0x83 answer or monitor upload: 5A A5 LEN 83 AH AL N,
+ * the data and a CRC must fit a pool block, and LEN = 2 * N + 6 one byte.
+ */
+#if (POOL_BLOCK_SIZE - 9) / 2 < 124
+#define DGUS_READ_WORDS_MAX ((POOL_BLOCK_SIZE - 9) / 2)
+#else
+#define DGUS_READ_WORDS_MAX 124
+#endif
+
+#if UART4_NODE > 254 || UART5_NODE > 254
+#error "UART4_NODE / UART5_NODE must be 1..254, or 0 for no address byte"
+#endif
+#if (UART4_NODE && UART4_PROTO != UART_PROTO_DGUS) || (UART5_NODE && UART5_PROTO != UART_PROTO_DGUS)
+#error "UARTx_NODE applies to DGUS ports only (Modbus frames carry their own address)"
+#endif
+
+/* Gateway routes (src/app/route_list.txt): both ends must be enabled ports */
+#if (ROUTE_FRAMES2 || ROUTE_RAW2 || ROUTE_IN2) && !UART2_ENABLE
+#error "src/app/route_list.txt uses UART2: set UART2_ENABLE 1"
+#endif
+#if (ROUTE_FRAMES3 || ROUTE_RAW3 || ROUTE_IN3) && !UART3_ENABLE
+#error "src/app/route_list.txt uses UART3: set UART3_ENABLE 1"
+#endif
+#if (ROUTE_FRAMES4 || ROUTE_RAW4 || ROUTE_IN4) && !UART4_ENABLE
+#error "src/app/route_list.txt uses UART4: set UART4_ENABLE 1"
+#endif
+#if (ROUTE_FRAMES5 || ROUTE_RAW5 || ROUTE_IN5) && !UART5_ENABLE
+#error "src/app/route_list.txt uses UART5: set UART5_ENABLE 1"
+#endif
+#if (ROUTE_IN2 && UART2_PROTO == UART_PROTO_MB_MASTER) || (ROUTE_IN3 && UART3_PROTO == UART_PROTO_MB_MASTER) || \
+    (ROUTE_IN4 && UART4_PROTO == UART_PROTO_MB_MASTER) || (ROUTE_IN5 && UART5_PROTO == UART_PROTO_MB_MASTER)
+#error "routes cannot send into a Modbus master bus: its requests would collide"
+#endif
+
+/* uart_send_block() classes; what main composes in the TX ring goes first */
+#define UART_TX_HIGH 0 // request / response traffic (routed frames, Modbus answers)
+#define UART_TX_LOW 1  // unsolicited auto-uploads
+
+extern __xdata u16 route_frames; // frames forwarded by a route
+extern __xdata u16 route_drops;  // routed frames dropped: target queue full
+extern __xdata u16 dgus_reply_drops; // 0x83 reads left unanswered: no pool block
 
 extern __bit Response_flog;    // for response
 extern __bit Auto_data_upload; // For automatic data upload
 extern __bit Crc_check_flog;   // Crc check mark
 extern __bit g_in_download_mode;
 // uart.h
-extern volatile __xdata u8 T_O2;
-extern volatile __xdata u8 T_O3; // Port 3 timeout counter
-extern volatile __xdata u8 T_O4; // Port 4 timeout counter
-extern volatile __xdata u8 T_O5; // Port 5 timeout counter
+extern volatile MEM_HOT u8 T_O2;
+extern volatile MEM_HOT u8 T_O3; // Port 3 timeout counter
+extern volatile MEM_HOT u8 T_O4; // Port 4 timeout counter
+extern volatile MEM_HOT u8 T_O5; // Port 5 timeout counter
 
 void Uart_Init(void);
-void uart2_ISR(void) __interrupt(4);
-void uart3_ISR(void) __interrupt(16);
-void uart4_RISR(void) __interrupt(11);
-void uart5_RISR(void) __interrupt(13);
+void uart2_ISR(void) __interrupt(4) IRQ_USING_RX;
+void uart3_ISR(void) __interrupt(16) IRQ_USING_RX;
+void uart4_RISR(void) __interrupt(11) IRQ_USING_RX;
+void uart5_RISR(void) __interrupt(13) IRQ_USING_RX;
 
 void uart_send_byte(u8 Uart_number, u8 Dat);
 void uart_send_word(u8 Uart_number, u16 data);
 void uart_send_str(u8 Uart_number, u8 *str);
 void uart_send_arr(u8 Uart_number, u8 *arr, u8 len);
+void uart_send_frame(u8 uart, const u8 *frame, u16 len);
+u8 uart_send_block(u8 uart, __xdata u8 *blk, u16 len, u8 prio);
 void DGUS_MonitorAndSendUpdates(void);
-void DGUS_HandleCmd82(u8 uart, u8 *frame);
+u8 DGUS_HandleCmd82(u8 uart, u8 *frame);
 void DGUS_HandleCmd83(u8 uart, u8 *response, const u8 *request);
 void DGUS_ParseUartFrame(u8 *rx_buf, u16 *data_len, u8 uart, __bit response, __bit crc_check);
 void DGUS_ProcessAllUarts(void);
+u8 DGUS_UartFramePending(void);
 void uart_4_5_pin_ctrl(u8 uart_num, u8 state);
+void uart_4_5_release(u8 uart_num);
 #endif
\ No newline at end of file
@@ -0,0 +1,100 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : vpinit.c / vpinit.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Boot-time VP initialization, see vpinit.h.
+ * ----------------------------------------------------------------------------- */
+#define VP_INIT_DEFINE
+#include "vpinit.h"
+#include "sys.h"
+
+#if VP_INIT_RUNS
+
+/* Write every run from the __code image, 254 VPs per DGUS_WriteWords() call */
+static void vp_init_from_code(void)
+{
+    u8 r;
+
+    for (r = 0; r < VP_INIT_RUNS; r++)
+    {
+        u16 vp = VP_Init_First[r];
+        u16 left = VP_Init_Len[r];
+        const u16 *src = &VP_Init_Data[VP_Init_Off[r]];
+
+        while (left)
+        {
+            u8 n = (left > 254u) ? 254u : (u8)left;
+            DGUS_WriteWords(vp, src, n);
+            vp += n;
+            src += n;
+            left -= n;
+        }
+    }
+}
+
+#if VP_INIT_NOR
+/* NOR byte address of a word offset in the copy */
+#define VP_INIT_NOR_AT(words) (VP_INIT_NOR_ADDR + 2UL * (words))
+
+/* The NOR copy is current when its first two words hold VP_INIT_STAMP */
+static u8 vp_init_nor_valid(void)
+{
+    if (!DGUS_NOR_Read(VP_INIT_NOR_ADDR, VP_INIT_SCRATCH_VP, 4))
+        return 0;
+    return DGUS_Read_VP(VP_INIT_SCRATCH_VP) == (u16)(VP_INIT_STAMP >> 16) &&
+           DGUS_Read_VP(VP_INIT_SCRATCH_VP + 1) == (u16)VP_INIT_STAMP;
+}
+
+/* Save the runs just written to VP RAM, then the stamp that validates them */
+static void vp_init_nor_save(void)
+{
+    u8 r;
+
+    for (r = 0; r < VP_INIT_RUNS; r++)
+        if (!DGUS_NOR_Write(VP_INIT_NOR_AT(VP_Init_Nor[r]), VP_Init_First[r], 2u * VP_Init_Len[r]))
+            return; // no stamp: retried on the next boot
+
+    DGUS_Write_VP(VP_INIT_SCRATCH_VP, (u16)(VP_INIT_STAMP >> 16));
+    DGUS_Write_VP(VP_INIT_SCRATCH_VP + 1, (u16)VP_INIT_STAMP);
+    DGUS_NOR_Write(VP_INIT_NOR_ADDR, VP_INIT_SCRATCH_VP, 4);
+}
+#endif
+
+/**
+ * @brief Load the boot VP values, one bulk transfer per contiguous run.
+ *
+ * With VP_INIT_NOR the runs come from the NOR copy at VP_INIT_NOR_ADDR
+ * (the DGUS core does the copy); after a firmware update that changed the
+ * table the __code image is written once and saved to NOR for later boots.
+ * Call after Sys_Init() and before App_Init(), which may override values.
+ */
+void VP_Init_Apply(void)
+{
+#if VP_INIT_NOR
+    u8 r;
+
+    if (vp_init_nor_valid())
+    {
+        for (r = 0; r < VP_INIT_RUNS; r++)
+            if (!DGUS_NOR_Read(VP_INIT_NOR_AT(VP_Init_Nor[r]), VP_Init_First[r], 2u * VP_Init_Len[r]))
+                break;
+        if (r == VP_INIT_RUNS)
+            return;
+    }
+    vp_init_from_code();
+    vp_init_nor_save();
+#else
+    vp_init_from_code();
+#endif
+}
+
+#else
+
+void VP_Init_Apply(void)
+{
+    // empty init list
+}
+
+#endif
@@ -0,0 +1,22 @@
+/* -----------------------------------------------------------------------------
+ *  Project : DWIN-T5L-SDCC-Template
+ *  File    : vpinit.c / vpinit.h
+ *  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+ *  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+ *  Contact : recepsenbas@gmail.com
+ *  Description : Boot-time VP initialization from the generated table
+ *                (src/app/vp_init.txt -> build/gen/vp_init_table.h).
+ *                Each contiguous run is one DGUS RAM burst from __code, or
+ *                with VP_INIT_NOR one NOR-to-VP transfer from a copy that is
+ *                (re)written whenever the table stamp changes.
+ * ----------------------------------------------------------------------------- */
+#ifndef __VPINIT_H__
+#define __VPINIT_H__
+
+#include "t5l1.h"
+#include "config.h"
+#include "vp_init_table.h"
+
+void VP_Init_Apply(void);
+
+#endif
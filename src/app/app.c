@@ -23,3 +23,8 @@ void App_Init(void)
     // Initialize application-specific settings
     DGUS_Write_VP(ICON_WORKING_ADDR, working_status);
 }
+
+void App_Task(void)
+{
+    // Periodic application logic, runs every APP_PERIOD_MS (see main.c)
+}
@@ -20,14 +20,20 @@
  * (typically detected inside a UART RX ISR or frame parser).
  *
  * How it works
- *  - Define the watch list in Flags_Uart[] and keep a parallel Flag_States[] array.
- *  - Call Flags_SetByUart(vp) from your ISR/parser when you detect that UART data changed.
+ *  - Declare the watched VPs (single addresses or ranges) as 'uart' rows in
+ *    src/app/watch_list.txt; the Makefile generates the sorted __code table
+ *    (build/gen/watch_table.h) shared with vp_flags.h.
+ *  - Call Flags_SetByUart(uart, cmd, vp, value) from your parser for every VP a
+ *    frame touches. Lookup is a binary search over the ranges; a hit raises the
+ *    flag and queues an event (lib/event) with port, command, VP and value.
+ *  - Event_Dispatch() in the main loop runs the range handler once per event,
+ *    so back-to-back writes are not merged.
  *  - In the main loop, poll the flag macros (e.g., start_button_flag) or the
- *    Flag_States[] entries, handle the event, then clear the flag (write 0).
+ *    Uart_Flag_States[] entries, handle the event, then clear the flag (write 0).
  *
  * One-definition rule
  *  - In exactly ONE C file, define UART_FLAGS_DEFINE before including this header so
- *    that the storage for Flags_Uart[] and Flag_States[] is emitted there.
+ *    that the storage for the Uart_Watch_* tables and Uart_Flag_States[] is emitted there.
  *    Example (uart.c):
  *      #define UART_FLAGS_DEFINE
  *      #include "uart_flags.h"
@@ -35,20 +41,20 @@
  *      #include "uart_flags.h"
  *
  * Concurrency / ISR notes
- *  - Flag_States[] lives in XRAM and is declared 'volatile' because it is written
+ *  - Uart_Flag_States[] lives in XRAM and is declared 'volatile' because it is written
  *    from ISRs and read from the main context.
  *  - Clearing a single-byte flag is effectively atomic on 8051. For multi-flag
  *    operations that must be atomic, briefly mask UART interrupts or wrap with
  *    EA save/restore as your system allows.
  *
  * Customization
- *  - Update FLAGS_COUNT and the initializer of Flags_Uart[] if you add/remove addresses.
- *  - The convenience macros (flag_1..flag_4,g) map indices to
+ *  - Edit src/app/watch_list.txt only; counts, enum and tables follow from it.
+ *  - The accessor column (uart_flag_1.., uart_start_flag) maps indices to
  *    readable names—rename them to match your UI semantics.
  *
  * Example usage
  *  // In UART RX ISR after parsing a complete frame:
- *  //   Flags_SetByUart(last_addr);
+ *  //   Flags_SetByUart(uart, 0x82, addr, value);
  *
  *  // In main loop:
  *  //   if (start_button_flag) {
@@ -60,6 +66,7 @@
 #define __UART_FLAGS_H__
 
 #include "t5l1.h"
+#include "event.h"
 
 /* One-TU storage selector: define UART_FLAGS_DEFINE in exactly ONE C file */
 #ifdef UART_FLAGS_DEFINE
@@ -68,65 +75,56 @@
 #define UART_FLAGS_EXTERN extern
 #endif
 
-/* Change count here if you add/remove VPs */
-#define UART_FLAGS_COUNT 5
-
-/* --- Watch list of DGUS UARTs --- */
-#ifdef UART_FLAGS_DEFINE
-const u16 Flags_Uart[UART_FLAGS_COUNT] = {0x2100, 0x2102, 0x2104, 0x2106, 0x3000};
-#else
-UART_FLAGS_EXTERN const u16 Flags_Uart[UART_FLAGS_COUNT];
-#endif
+/* --- Watch table, flag enum and accessor macros (generated) --- */
+#include "watch_table.h"
 
+#if UART_FLAGS_COUNT
 /* --- Per-UART software flags (lives in XRAM, written in ISR) --- */
 #ifdef UART_FLAGS_DEFINE
-volatile __xdata u8 Uart_Flag_States[UART_FLAGS_COUNT] = {0, 0, 0, 0, 0};
+volatile __xdata u8 Uart_Flag_States[UART_FLAGS_COUNT] = {0};
 #else
 UART_FLAGS_EXTERN volatile __xdata u8 Uart_Flag_States[UART_FLAGS_COUNT];
 #endif
-
-/* --- Convenience macros for named access --- */
-// #define Uart_FLAG_1 0
-// #define Uart_FLAG_2 1
-// #define Uart_FLAG_3 2
-// #define Uart_FLAG_4 3
-// #define Uart_FLAG_5 4
-enum
-{
-    Uart_FLAG_1 = 0,
-    Uart_FLAG_2,
-    Uart_FLAG_3,
-    Uart_FLAG_4,
-    Uart_FLAG_5
-};
-
-#define uart_flag_1 (Uart_Flag_States[Uart_FLAG_1])
-#define uart_flag_2 (Uart_Flag_States[Uart_FLAG_2])
-#define uart_flag_3 (Uart_Flag_States[Uart_FLAG_3])
-#define uart_flag_4 (Uart_Flag_States[Uart_FLAG_4])
-#define uart_start_flag (Uart_Flag_States[Uart_FLAG_5])
+#endif
 
 /* Helpers (header-inline) */
-static inline void Flags_SetByUart(u16 vp)
+static inline void Flags_SetByUart(u8 uart, u8 cmd, u16 vp, u16 value)
 {
-    u8 i;
-    for (i = 0; i < UART_FLAGS_COUNT; i++)
+#if UART_WATCH_COUNT
+    u16 lo = 0;
+    u16 hi = UART_WATCH_COUNT;
+
+    while (lo < hi)
     {
-        if (Flags_Uart[i] == vp)
+        u16 mid = (lo + hi) >> 1;
+        if (vp < Uart_Watch_First[mid])
+            hi = mid;
+        else if (vp > Uart_Watch_Last[mid])
+            lo = mid + 1;
+        else
         {
-            Uart_Flag_States[i] = 1;
+            Uart_Flag_States[Uart_Watch_Flag[mid]] = 1;
+            Event_Post(uart, cmd, vp, value, mid);
             break;
         }
     }
+#else
+    (void)uart;
+    (void)cmd;
+    (void)vp;
+    (void)value;
+#endif
 }
 
 static inline void Uart_Flags_ClearAll(void)
 {
-    u8 i;
+#if UART_FLAGS_COUNT
+    u16 i;
     for (i = 0; i < UART_FLAGS_COUNT; i++)
     {
         Uart_Flag_States[i] = 0;
     }
+#endif
 }
 
 #endif /* __UART_FLAGS_H__ */
\ No newline at end of file
@@ -19,16 +19,23 @@
  * are written/changed (typically detected inside a UART RX ISR or frame parser).
  *
  * How it works
- *  - Define the watch list in Flags_VPs[] and keep a parallel VP_Flag_States[] array.
- *  - Call Flags_SetByVP(vp) from your ISR/parser when you detect that VP 'vp' changed.
+ *  - Declare the watched VPs (single addresses or ranges) as 'vp' rows in
+ *    src/app/watch_list.txt. The Makefile runs tools/watch_gen.awk and emits
+ *    build/gen/watch_table.h: a table sorted by first VP in __code, the flag
+ *    enum, the accessor macros and an optional handler per range.
+ *  - Call Flags_SetByVP(vp, value) from your ISR/parser when you detect that VP 'vp' changed.
+ *    The lookup is a binary search, so cost grows with log2(ranges), not with
+ *    the length of the list. A hit raises the flag and queues an event
+ *    (lib/event) carrying the VP, the new value and a timestamp.
  *  - In the main loop, poll the flag macros (e.g., start_button_flag) or the
  *    VP_Flag_States[] entries, handle the event, then clear the flag (write 0).
+ *    Ranges with a handler get one call per event from Event_Dispatch().
  *
  * One-definition rule
- *  - In exactly ONE C file, define FLAGS_DEFINE before including this header so
- *    that the storage for Flags_VPs[] and VP_Flag_States[] is emitted there.
+ *  - In exactly ONE C file, define VP_FLAGS_DEFINE before including this header so
+ *    that the storage for the VP_Watch_* tables and VP_Flag_States[] is emitted there.
  *    Example (uart.c):
- *      #define FLAGS_DEFINE
+ *      #define VP_FLAGS_DEFINE
  *      #include "app/vp_flags.h"
  *  - In all other files, simply:
  *      #include "app/vp_flags.h"
@@ -41,13 +48,14 @@
  *    EA save/restore as your system allows.
  *
  * Customization
- *  - Update FLAGS_COUNT and the initializer of Flags_VPs[] if you add/remove VPs.
- *  - The convenience macros (flag_1..flag_4, start_button_flag) map indices to
+ *  - Edit src/app/watch_list.txt only; counts, enum and tables follow from it.
+ *    Overlapping ranges are rejected at build time.
+ *  - The accessor column (vp_flag_1.., vp_start_button_flag) maps indices to
  *    readable names—rename them to match your UI semantics.
  *
  * Example usage
  *  // In UART RX ISR after parsing a complete frame:
- *  //   Flags_SetByVP(last_addr);
+ *  //   Flags_SetByVP(vp, value);
  *
  *  // In main loop:
  *  //   if (start_button_flag) {
@@ -59,73 +67,63 @@
 #define __VP_FLAGS_H__
 
 #include "t5l1.h"
+#include "event.h"
 
-/* One-TU storage selector: define FLAGS_DEFINE in exactly ONE C file */
+/* One-TU storage selector: define VP_FLAGS_DEFINE in exactly ONE C file */
 #ifdef VP_FLAGS_DEFINE
 #define VP_FLAGS_EXTERN
 #else
 #define VP_FLAGS_EXTERN extern
 #endif
 
-/* Change count here if you add/remove VPs */
-#define VP_FLAGS_COUNT 5
-
-/* --- Watch list of DGUS VPs --- */
-#ifdef VP_FLAGS_DEFINE
-const u16 Flags_VPs[VP_FLAGS_COUNT] = {0x2100, 0x2102, 0x2104, 0x2106, 0x3000};
-#else
-VP_FLAGS_EXTERN const u16 Flags_VPs[VP_FLAGS_COUNT];
-#endif
+/* --- Watch table, flag enum and accessor macros (generated) --- */
+#include "watch_table.h"
 
+#if VP_FLAGS_COUNT
 /* --- Per-VP software flags (lives in XRAM, written in ISR) --- */
 #ifdef VP_FLAGS_DEFINE
-volatile __xdata u8 VP_Flag_States[VP_FLAGS_COUNT] = {0, 0, 0, 0, 0};
+volatile __xdata u8 VP_Flag_States[VP_FLAGS_COUNT] = {0};
 #else
 VP_FLAGS_EXTERN volatile __xdata u8 VP_Flag_States[VP_FLAGS_COUNT];
 #endif
-
-/* --- Convenience macros for named flags --- */
-// #define VP_FLAG_1 0
-// #define VP_FLAG_2 1
-// #define VP_FLAG_3 2
-// #define VP_FLAG_4 3
-// #define VP_FLAG_5 4
-enum
-{
-    VP_FLAG_1 = 0,
-    VP_FLAG_2,
-    VP_FLAG_3,
-    VP_FLAG_4,
-    VP_FLAG_5
-};
-
-#define vp_flag_1 (VP_Flag_States[VP_FLAG_1])
-#define vp_flag_2 (VP_Flag_States[VP_FLAG_2])
-#define vp_flag_3 (VP_Flag_States[VP_FLAG_3])
-#define vp_flag_4 (VP_Flag_States[VP_FLAG_4])
-#define vp_start_button_flag (VP_Flag_States[VP_FLAG_5])
+#endif
 
 /* Helpers (header-inline) */
-static inline void Flags_SetByVP(u16 vp)
+static inline void Flags_SetByVP(u16 vp, u16 value)
 {
-    u8 i;
-    for (i = 0; i < VP_FLAGS_COUNT; i++)
+#if VP_WATCH_COUNT
+    u16 lo = 0;
+    u16 hi = VP_WATCH_COUNT;
+
+    while (lo < hi)
     {
-        if (Flags_VPs[i] == vp)
+        u16 mid = (lo + hi) >> 1;
+        if (vp < VP_Watch_First[mid])
+            hi = mid;
+        else if (vp > VP_Watch_Last[mid])
+            lo = mid + 1;
+        else
         {
-            VP_Flag_States[i] = 1;
+            VP_Flag_States[VP_Watch_Flag[mid]] = 1;
+            Event_Post(EVT_SRC_MONITOR, EVT_CMD_CHANGE, vp, value, mid);
             break;
         }
     }
+#else
+    (void)vp;
+    (void)value;
+#endif
 }
 
 static inline void VP_Flags_ClearAll(void)
 {
-    u8 i;
+#if VP_FLAGS_COUNT
+    u16 i;
     for (i = 0; i < VP_FLAGS_COUNT; i++)
     {
         VP_Flag_States[i] = 0;
     }
+#endif
 }
 
 #endif /* __VP_FLAGS_H__ */
\ No newline at end of file
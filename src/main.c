@@ -14,6 +14,12 @@
 #include "sys.h"
 #include "timer.h"
 #include "rtc.h"
+#include "event.h"
+#include "sched.h"
+#include "swtimer.h"
+#include "prof.h"
+#include "vpinit.h"
+#include "modbus.h"
 #include "vp_flags.h"
 #include "uart_flags.h"
 #include "app_defs.h"
@@ -23,15 +29,28 @@ void main(void)
 {
     Sys_Init();
     Uart_Init();
-    RTC_Service();
+    VP_Init_Apply(); // boot VP values (src/app/vp_init.txt) in bulk
     App_Init();
 
+    /* Tasks: body, period ms (0 = every pass), phase ms, priority (0 = highest), budget ms */
+    Sched_Add(DGUS_ProcessAllUarts, 0, 0, 0, 25);                       // incoming UART frames
+    Sched_Add(SwTimer_Process, 0, 0, 1, 5);                             // software timer callbacks
+    Sched_Add(Event_Dispatch, 0, 0, 2, 5);                              // VP/UART change handlers
+    Sched_Add(DGUS_MonitorAndSendUpdates, MONITOR_PERIOD_MS, 0, 3, 25); // DGUS auto-upload
+    Sched_Add(RTC_Service, RTC_POLL_MS, 0, 4, 30);                      // RTC read / DGUS mirror
+    Sched_Add(App_Task, APP_PERIOD_MS, 5, 5, APP_PERIOD_MS);            // application logic
+    Sched_Add(Sched_LoadUpdate, LOAD_PERIOD_MS, 9, 6, 5);               // idle/busy counters
+#if MB_POLL_COUNT
+    Sched_Add(Modbus_MasterTask, 1, 0, 1, 5);                           // Modbus master timeouts / polls
+#endif
+#if PROFILE_ENABLE
+    Sched_Add(Prof_Export, PROF_EXPORT_MS, 7, 6, 50);                   // stats -> PROF_VP_BASE
+#endif
+
     while (1)
     {
-        /* Monitor DGUS register and send updates */
-        DGUS_MonitorAndSendUpdates();
-
-        /* Check for incoming UART data and process it */
-        DGUS_ProcessAllUarts();
+        Sched_Run();
+        if (!Sched_Due() && !Event_Pending() && !DGUS_UartFramePending())
+            Sched_Idle(); // nothing to do until the next tick
     }
 }
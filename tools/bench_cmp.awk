@@ -0,0 +1,126 @@
+# ------------------------------------------------------------------------------
+#  Project : DWIN-T5L-SDCC-Template
+#  File    : bench_cmp.awk
+#  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+#  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+#  Contact : recepsenbas@gmail.com
+#  Description : Turns the ucsim bench_cycles[] dump into per-case cycle
+#                counts and compares them with the stored baseline.
+#                Case names come from the "BENCH_xxx, // name" enum lines of
+#                bench/bench_main.c (first file), the dump from the ucsim log
+#                (second file). Writes "name cycles" lines to `out`, prints
+#                the comparison and exits 1 when a case is more than `tol`
+#                percent slower than `baseline`.
+#                POSIX awk only (no strtonum) so it runs under MSYS2 too.
+#
+#  Usage : awk -v start=0x8123 -v out=bench.txt -v baseline=bench/baseline.txt \
+#              -v tol=5 -f tools/bench_cmp.awk bench/bench_main.c ucsim.log
+# ------------------------------------------------------------------------------
+
+function hex2dec(h, i, d, v)
+{
+    h = toupper(h)
+    if (substr(h, 1, 2) == "0X")
+        h = substr(h, 3)
+    v = 0
+    for (i = 1; i <= length(h); i++) {
+        d = index("0123456789ABCDEF", substr(h, i, 1)) - 1
+        if (d < 0)
+            return -1
+        v = v * 16 + d
+    }
+    return v
+}
+
+BEGIN {
+    ncase = 0
+    base_addr = hex2dec(start)
+    if (tol == "")
+        tol = 5
+}
+
+# ---- case names from the enum in bench_main.c ----
+FNR == NR {
+    if ($0 ~ /^[ \t]*BENCH_[A-Z0-9_]+,[ \t]*\/\/[ \t]*[A-Za-z0-9_]+/) {
+        sub(/.*\/\/[ \t]*/, "")
+        name[ncase++] = $1
+    }
+    next
+}
+
+# ---- ucsim "dump xram" lines: 0xADDR bb bb ... (prompt text may precede) ----
+{
+    for (i = 1; i <= NF; i++)
+        if ($i ~ /^0x[0-9a-fA-F]+$/)
+            break
+    if (i > NF)
+        next
+    a = hex2dec($i)
+    if (a < base_addr || a >= base_addr + 2 * ncase)
+        next
+    for (j = i + 1; j <= NF && j <= i + 8 && $j ~ /^[0-9a-fA-F][0-9a-fA-F]$/; j++)
+        byte[a - base_addr + j - i - 1] = hex2dec($j)
+}
+
+END {
+    if (!ncase) {
+        print "bench_cmp: no BENCH_ cases found" > "/dev/stderr"
+        exit 1
+    }
+    for (c = 0; c < ncase; c++) {
+        if (!((2 * c) in byte) || !((2 * c + 1) in byte)) {
+            print "bench_cmp: no cycle data for " name[c] " in the ucsim log" > "/dev/stderr"
+            exit 1
+        }
+        cyc[c] = byte[2 * c] + 256 * byte[2 * c + 1] # SDCC stores u16 little-endian
+    }
+
+    have_base = 0
+    if (baseline != "") {
+        while ((getline line < baseline) > 0) {
+            split(line, f, " ")
+            if (f[1] != "" && f[1] !~ /^#/) {
+                base[f[1]] = f[2] + 0
+                have_base = 1
+            }
+        }
+        close(baseline)
+    }
+
+    if (out != "") {
+        print "# name cycles (ucsim machine cycles, timer overhead removed)" > out
+        for (c = 0; c < ncase; c++)
+            print name[c], cyc[c] > out
+        close(out)
+    }
+
+    printf("%-18s %8s %8s %8s\n", "case", "cycles", "base", "delta")
+    fail = 0
+    for (c = 0; c < ncase; c++) {
+        n = name[c]
+        if (cyc[c] == 65535)
+            note = "  overflow (> 65534 cycles)"
+        else
+            note = ""
+        if (!have_base || !(n in base) || c == 0) {
+            printf("%-18s %8d %8s %8s%s\n", n, cyc[c], "-", "-", note)
+            continue
+        }
+        b = base[n]
+        d = b ? (cyc[c] - b) * 100.0 / b : 0
+        if (cyc[c] > b && (cyc[c] == 65535 || d > tol)) {
+            note = note "  REGRESSION"
+            fail = 1
+        } else if (d < -tol) {
+            note = note "  faster"
+        }
+        printf("%-18s %8d %8d %+7.1f%%%s\n", n, cyc[c], b, d, note)
+    }
+    if (!have_base)
+        print "no baseline yet: run 'make bench-baseline' to store this run"
+    else if (fail)
+        printf("❌ cycle regression above %s%%\n", tol)
+    else
+        printf("✅ within %s%% of the baseline\n", tol)
+    exit fail
+}
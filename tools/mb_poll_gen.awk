@@ -0,0 +1,207 @@
+# ------------------------------------------------------------------------------
+#  Project : DWIN-T5L-SDCC-Template
+#  File    : mb_poll_gen.awk
+#  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+#  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+#  Contact : recepsenbas@gmail.com
+#  Description : Build-time generator for the Modbus master poll table.
+#                Reads src/app/mb_poll.txt and prints mb_poll_table.h: rows
+#                of the same port, device, function and period whose
+#                registers and VPs both continue each other are merged into
+#                one request (up to 125 registers), devices get an index for
+#                their timeout/retry state, and per-port entry counts let
+#                modbus.h check the UARTx_PROTO settings.
+#                POSIX awk only (no asort/strtonum) so it runs under MSYS2 too.
+#
+#  Usage : awk -f tools/mb_poll_gen.awk src/app/mb_poll.txt > mb_poll_table.h
+# ------------------------------------------------------------------------------
+
+function hex2dec(h, i, d, v)
+{
+    h = toupper(h)
+    if (substr(h, 1, 2) != "0X")
+        return h + 0
+    h = substr(h, 3)
+    v = 0
+    for (i = 1; i <= length(h); i++) {
+        d = index("0123456789ABCDEF", substr(h, i, 1)) - 1
+        if (d < 0)
+            fail("bad hex number '" h "'")
+        v = v * 16 + d
+    }
+    return v
+}
+
+function hex4(v)
+{
+    return sprintf("0x%04X", v)
+}
+
+function fail(msg)
+{
+    printf("%s:%d: %s\n", FILENAME, FNR, msg) > "/dev/stderr"
+    failed = 1
+    exit 1
+}
+
+BEGIN {
+    nrow = 0
+}
+
+/^[ \t]*(#|$)/ { next }
+
+{
+    sub(/[ \t]*#.*/, "")
+    if (NF != 7)
+        fail("expected 7 columns (uart dev fc first count vp period), got " NF)
+    uart = $1 + 0
+    dev = hex2dec($2)
+    fc = hex2dec($3)
+    first = hex2dec($4)
+    count = $5 + 0
+    vp = hex2dec($6)
+    period = $7 + 0
+    if (uart < 2 || uart > 5)
+        fail("uart must be 2..5")
+    if (dev < 1 || dev > 247)
+        fail("device address must be 1..247")
+    if (fc != 3 && fc != 4)
+        fail("function must be 3 (holding) or 4 (input registers)")
+    if (count < 1 || count > 125)
+        fail("count must be 1..125")
+    if (first + count > 65536)
+        fail("register range runs past 0xFFFF")
+    if (vp + count > 65536)
+        fail("VP range runs past 0xFFFF")
+    if (period > 65535)
+        fail("period does not fit in 16 bits")
+
+    # Insertion sort by port, device, function, period, first register
+    key = (((uart * 256 + dev) * 256 + fc) * 65536 + period) * 65536 + first
+    for (i = nrow; i > 0 && row_key[i - 1] > key; i--) {
+        row_key[i] = row_key[i - 1]
+        row_uart[i] = row_uart[i - 1]; row_dev[i] = row_dev[i - 1]; row_fc[i] = row_fc[i - 1]
+        row_first[i] = row_first[i - 1]; row_count[i] = row_count[i - 1]
+        row_vp[i] = row_vp[i - 1]; row_period[i] = row_period[i - 1]
+    }
+    row_key[i] = key
+    row_uart[i] = uart; row_dev[i] = dev; row_fc[i] = fc
+    row_first[i] = first; row_count[i] = count
+    row_vp[i] = vp; row_period[i] = period
+    nrow++
+}
+
+END {
+    if (failed)
+        exit 1
+
+    nent = 0
+    ndev = 0
+    for (s = 2; s <= 5; s++)
+        port_ent[s] = 0
+    for (i = 0; i < nrow; i++) {
+        same = nent && row_uart[i] == ent_uart[nent - 1] && row_dev[i] == ent_dev_addr[nent - 1] &&
+               row_fc[i] == ent_fc[nent - 1] && row_period[i] == ent_period[nent - 1]
+        if (same && row_first[i] < ent_first[nent - 1] + ent_count[nent - 1]) {
+            printf("mb_poll_gen: uart %d device %d registers %s and %s overlap\n", row_uart[i], row_dev[i],
+                   hex4(ent_first[nent - 1]), hex4(row_first[i])) > "/dev/stderr"
+            exit 1
+        }
+        if (same && row_first[i] == ent_first[nent - 1] + ent_count[nent - 1] &&
+            row_vp[i] == ent_vp[nent - 1] + ent_count[nent - 1] &&
+            ent_count[nent - 1] + row_count[i] <= 125) {
+            ent_count[nent - 1] += row_count[i]
+            continue
+        }
+        dkey = row_uart[i] SUBSEP row_dev[i]
+        if (!(dkey in dev_of)) {
+            dev_of[dkey] = ndev
+            dev_uart[ndev] = row_uart[i]
+            dev_addr[ndev] = row_dev[i]
+            ndev++
+        }
+        ent_uart[nent] = row_uart[i]
+        ent_dev_addr[nent] = row_dev[i]
+        ent_dev[nent] = dev_of[dkey]
+        ent_fc[nent] = row_fc[i]
+        ent_first[nent] = row_first[i]
+        ent_count[nent] = row_count[i]
+        ent_vp[nent] = row_vp[i]
+        ent_period[nent] = row_period[i]
+        port_ent[row_uart[i]]++
+        nent++
+    }
+    if (ndev > 64) {
+        print "mb_poll_gen: more than 64 devices" > "/dev/stderr"
+        exit 1
+    }
+
+    print "/* -----------------------------------------------------------------------------"
+    print " *  Project : DWIN-T5L-SDCC-Template"
+    print " *  File    : mb_poll_table.h (generated)"
+    print " *  Description : Generated by tools/mb_poll_gen.awk from " FILENAME "."
+    print " *                Do not edit; change the poll list and rebuild."
+    print " * ----------------------------------------------------------------------------- */"
+    print "#ifndef __MB_POLL_TABLE_H__"
+    print "#define __MB_POLL_TABLE_H__"
+    print ""
+    print "#include \"t5l1.h\""
+    print ""
+    print "/* " nrow " row(s) merged into " nent " request(s), " ndev " device(s) */"
+    print "#define MB_POLL_COUNT " nent
+    print "#define MB_POLL_DEVICES " ndev
+    for (s = 2; s <= 5; s++)
+        print "#define MB_POLL_UART" s " " port_ent[s]
+    if (nent) {
+        print ""
+        print "extern __code const u8 MB_Poll_Uart[MB_POLL_COUNT];"
+        print "extern __code const u8 MB_Poll_Dev[MB_POLL_COUNT];"
+        print "extern __code const u8 MB_Poll_Fc[MB_POLL_COUNT];"
+        print "extern __code const u16 MB_Poll_Reg[MB_POLL_COUNT];"
+        print "extern __code const u8 MB_Poll_Qty[MB_POLL_COUNT];"
+        print "extern __code const u16 MB_Poll_Vp[MB_POLL_COUNT];"
+        print "extern __code const u16 MB_Poll_Period[MB_POLL_COUNT];"
+        print "extern __code const u8 MB_Dev_Addr[MB_POLL_DEVICES];"
+    }
+    print ""
+    print "#endif /* __MB_POLL_TABLE_H__ */"
+
+    if (!nent)
+        exit 0
+    print ""
+    print "#if defined(MB_POLL_DEFINE) && !defined(__MB_POLL_STORAGE__)"
+    print "#define __MB_POLL_STORAGE__"
+    printf("__code const u8 MB_Poll_Uart[MB_POLL_COUNT] = {")
+    for (i = 0; i < nent; i++)
+        printf("%s%d", (i ? ", " : ""), ent_uart[i])
+    print "};"
+    printf("__code const u8 MB_Poll_Dev[MB_POLL_COUNT] = {")
+    for (i = 0; i < nent; i++)
+        printf("%s%d", (i ? ", " : ""), ent_dev[i])
+    print "};"
+    printf("__code const u8 MB_Poll_Fc[MB_POLL_COUNT] = {")
+    for (i = 0; i < nent; i++)
+        printf("%s%d", (i ? ", " : ""), ent_fc[i])
+    print "};"
+    printf("__code const u16 MB_Poll_Reg[MB_POLL_COUNT] = {")
+    for (i = 0; i < nent; i++)
+        printf("%s%s", (i ? ", " : ""), hex4(ent_first[i]))
+    print "};"
+    printf("__code const u8 MB_Poll_Qty[MB_POLL_COUNT] = {")
+    for (i = 0; i < nent; i++)
+        printf("%s%d", (i ? ", " : ""), ent_count[i])
+    print "};"
+    printf("__code const u16 MB_Poll_Vp[MB_POLL_COUNT] = {")
+    for (i = 0; i < nent; i++)
+        printf("%s%s", (i ? ", " : ""), hex4(ent_vp[i]))
+    print "};"
+    printf("__code const u16 MB_Poll_Period[MB_POLL_COUNT] = {")
+    for (i = 0; i < nent; i++)
+        printf("%s%d", (i ? ", " : ""), ent_period[i])
+    print "};"
+    printf("__code const u8 MB_Dev_Addr[MB_POLL_DEVICES] = {")
+    for (d = 0; d < ndev; d++)
+        printf("%s%d", (d ? ", " : ""), dev_addr[d])
+    print "};"
+    print "#endif"
+}
@@ -0,0 +1,280 @@
+# ------------------------------------------------------------------------------
+#  Project : DWIN-T5L-SDCC-Template
+#  File    : mem_check.awk
+#  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+#  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+#  Contact : recepsenbas@gmail.com
+#  Description : Second half of the memory summary.
+#                - Checks that the MEM_HOT / MEM_WARM globals named in `hot`
+#                  ended up in DATA/IDATA according to the linker map.
+#                - Walks the SDCC .asm call graph and reports, per ISR, the
+#                  worst-case stack (pushes + return addresses down the call
+#                  chain) and the DATA/overlay and XDATA locals of that chain,
+#                  then compares main + nested ISRs with the room above the
+#                  stack start (SSEG).
+#                Estimates: pushes are followed linearly per function,
+#                library helpers (__mulint, __gptrget ...) count LIB_STACK
+#                bytes, indirect calls count the deepest address-taken
+#                function. Nesting is one ISR per IRQ_PRIO level in use.
+#                POSIX awk only (no strtonum) so it runs under MSYS2 too.
+#
+#  Usage : awk -v hot="_R_CN2 _T_O2" -f tools/mem_check.awk \
+#              build/dist/output.map include/config.h build/obj/*.asm
+# ------------------------------------------------------------------------------
+
+function hex2dec(h, i, d, v)
+{
+    h = toupper(h)
+    if (substr(h, 1, 2) == "0X")
+        h = substr(h, 3)
+    v = 0
+    for (i = 1; i <= length(h); i++) {
+        d = index("0123456789ABCDEF", substr(h, i, 1)) - 1
+        if (d < 0)
+            return -1
+        v = v * 16 + d
+    }
+    return v
+}
+
+# Worst-case stack bytes of f including everything it calls
+function depth(f, i, c, d, best)
+{
+    if (f in memo)
+        return memo[f]
+    if (!(f in known))
+        return LIB_STACK
+    if (f in busy) {
+        recursive[f] = 1
+        return 0
+    }
+    busy[f] = 1
+    best = pmax[f]
+    for (i = 0; i < ncall[f]; i++) {
+        c = callee[f, i]
+        d = cdepth[f, i] + 2 + (c == "*" ? indirect() : depth(c))
+        if (d > best)
+            best = d
+    }
+    delete busy[f]
+    memo[f] = best
+    return best
+}
+
+# Deepest function that is ever called through a pointer
+function indirect(g, d, best)
+{
+    best = 0
+    for (g in taken)
+        if ((g in known) && !(g in isr)) {
+            d = depth(g)
+            if (d > best)
+                best = d
+        }
+    return best
+}
+
+# Mark every function reachable from f (for the locals of a chain)
+function reach(f, i, c, g)
+{
+    if (f in seen || !(f in known))
+        return
+    seen[f] = 1
+    for (i = 0; i < ncall[f]; i++) {
+        c = callee[f, i]
+        if (c == "*") {
+            for (g in taken)
+                if (!(g in isr))
+                    reach(g)
+        } else {
+            reach(c)
+        }
+    }
+}
+
+BEGIN {
+    LIB_STACK = 4
+    nisr = 0
+    sstart = -1
+}
+
+# ---- linker map: area of each symbol, SSEG/OSEG ----
+FILENAME ~ /\.map$/ {
+    if ($0 ~ /^[A-Za-z0-9_.]+[ \t]+[0-9A-Fa-f]+[ \t]+[0-9A-Fa-f]+[ \t]*=/) {
+        area = $1
+        if (area == "SSEG")
+            sstart = hex2dec($2)
+        if (area == "OSEG")
+            oseg += hex2dec($3)
+        next
+    }
+    if (NF >= 2 && $1 ~ /^([A-Z]:)?$/ && $2 ~ /^[0-9A-Fa-f]+$/ && $3 ~ /^_/)
+        sym_area[$3] = area
+    else if (NF >= 2 && $1 ~ /^[0-9A-Fa-f]+$/ && $2 ~ /^_/)
+        sym_area[$2] = area
+    if ($0 ~ /__start__stack/)
+        for (i = 1; i < NF; i++)
+            if ($(i + 1) == "__start__stack" && sstart < 0)
+                sstart = hex2dec($i)
+    next
+}
+
+# ---- config.h: priority levels in use ----
+FILENAME ~ /config\.h$/ {
+    if ($1 == "#define" && $2 ~ /^IRQ_PRIO_G[0-5]$/)
+        level[$3 + 0] = 1
+    next
+}
+
+# ---- SDCC .asm: functions, pushes, calls, locals ----
+/^;[ \t]+function [A-Za-z_0-9]+/ {
+    fn = $3
+    known[fn] = 1
+    d = 0
+    next
+}
+/^;[ \t]*Allocation info for local variables in function/ {
+    alloc_fn = $0
+    sub(/.*function '/, "", alloc_fn)
+    sub(/'.*/, "", alloc_fn)
+    next
+}
+/Allocated with name '/ {
+    n = $0
+    sub(/.*Allocated with name '/, "", n)
+    sub(/'.*/, "", n)
+    owner[n] = alloc_fn
+    next
+}
+/^[ \t]*\.area/ {
+    cur_area = $2
+    fn = ""
+    next
+}
+/^[A-Za-z_][A-Za-z_0-9]*:/ {
+    label = $1
+    sub(/:.*/, "", label)
+    next
+}
+/^[ \t]+\.ds[ \t]/ {
+    if (label != "") {
+        dsize[label] = $2 + 0
+        darea[label] = cur_area
+    }
+    label = ""
+    next
+}
+fn != "" && /^[ \t]/ {
+    op = $1
+    arg = $2
+    if (op == "push") {
+        if (++d > pmax[fn])
+            pmax[fn] = d
+    } else if (op == "pop") {
+        if (d > 0)
+            d--
+    } else if (op == "reti") {
+        if (!(fn in isr)) {
+            isr[fn] = 1
+            isr_list[nisr++] = fn
+        }
+    } else if (op == "lcall" || op == "acall") {
+        k = ncall[fn]++
+        cdepth[fn, k] = d
+        if (arg == "__sdcc_call_dptr") {
+            callee[fn, k] = "*"
+        } else {
+            callee[fn, k] = substr(arg, 2)
+        }
+    }
+    # #_name: a function whose address is taken (function pointer)
+    for (i = 2; i <= NF; i++)
+        if ($i ~ /#_[A-Za-z_0-9]+/) {
+            t = $i
+            sub(/.*#_/, "", t)
+            sub(/[^A-Za-z_0-9].*/, "", t)
+            taken[t] = 1
+        }
+}
+
+END {
+    # ---- hot symbol placement ----
+    nh = split(hot, hs, " ")
+    bad = 0
+    placed = 0
+    for (i = 1; i <= nh; i++) {
+        a = sym_area[hs[i]]
+        if (a == "")
+            continue # compiled out (UARTx_ENABLE 0 ...)
+        if (a != "DSEG" && a != "ISEG" && a != "OSEG") {
+            printf("⚠️  Warning: hot symbol %s placed in %s, expected DATA/IDATA\n", hs[i], a)
+            bad = 1
+        } else {
+            placed++
+        }
+    }
+    if (placed && !bad)
+        printf("  HOT    %8d ISR-shared symbols in DATA/IDATA\n", placed)
+
+    if (!nisr) {
+        print "  (no .asm call graph found, stack report skipped)"
+        exit 0
+    }
+
+    # locals per function, by storage class
+    for (n in owner)
+        if (n in dsize) {
+            if (darea[n] ~ /^(DSEG|OSEG|ISEG)$/)
+                ldata[owner[n]] += dsize[n]
+            else
+                lxdata[owner[n]] += dsize[n]
+        }
+
+    printf("  ISR stack / locals (worst-case call chain, bytes):\n")
+    printf("    %-18s %6s %6s %6s\n", "function", "stack", "data", "xdata")
+    for (i = 0; i < nisr; i++) {
+        f = isr_list[i]
+        s[i] = depth(f)
+        for (g in seen)
+            delete seen[g]
+        reach(f)
+        dd = 0
+        xd = 0
+        for (g in seen) {
+            dd += ldata[g]
+            xd += lxdata[g]
+        }
+        printf("    %-18s %6d %6d %6d\n", f, s[i], dd, xd)
+    }
+    m = ("main" in known) ? depth("main") : 0
+    printf("    %-18s %6d\n", "main", m)
+    if (oseg)
+        printf("    overlay (OSEG) %10d bytes\n", oseg)
+
+    # main + deepest ISR per priority level
+    nl = 0
+    for (l in level)
+        nl++
+    if (!nl)
+        nl = 1
+    for (i = 0; i < nisr; i++)
+        for (j = i + 1; j < nisr; j++)
+            if (s[j] > s[i]) {
+                t = s[i]; s[i] = s[j]; s[j] = t
+            }
+    worst = m
+    for (i = 0; i < nisr && i < nl; i++)
+        worst += s[i]
+    for (f in recursive)
+        rec = rec " " f
+    if (rec != "")
+        printf("    recursion via:%s (counted once)\n", rec)
+    if (sstart >= 0) {
+        printf("  STACK  %8d worst case / %d free above 0x%02X (%d IRQ level(s) nested)\n",
+               worst, 256 - sstart, sstart, nl)
+        if (worst > 256 - sstart)
+            printf("⚠️  Warning: worst-case stack exceeds the IDATA left above the data!\n")
+    } else {
+        printf("  STACK  %8d worst case (%d IRQ level(s) nested)\n", worst, nl)
+    }
+}
@@ -0,0 +1,156 @@
+# ------------------------------------------------------------------------------
+#  Project : DWIN-T5L-SDCC-Template
+#  File    : route_gen.awk
+#  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+#  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+#  Contact : recepsenbas@gmail.com
+#  Description : Build-time generator for the UART gateway routes.
+#                Reads src/app/route_list.txt and prints route_table.h: frame
+#                routes keep the file order (first match wins) as __code
+#                arrays, raw bridges become one define per source port so
+#                uart.c can compile them in without a table lookup.
+#                POSIX awk only (no asort/strtonum) so it runs under MSYS2 too.
+#
+#  Usage : awk -f tools/route_gen.awk src/app/route_list.txt > route_table.h
+# ------------------------------------------------------------------------------
+
+function hex2dec(h, i, d, v)
+{
+    h = toupper(h)
+    if (substr(h, 1, 2) != "0X")
+        return h + 0
+    h = substr(h, 3)
+    v = 0
+    for (i = 1; i <= length(h); i++) {
+        d = index("0123456789ABCDEF", substr(h, i, 1)) - 1
+        if (d < 0)
+            fail("bad hex number '" h "'")
+        v = v * 16 + d
+    }
+    return v
+}
+
+function fail(msg)
+{
+    printf("%s:%d: %s\n", FILENAME, FNR, msg) > "/dev/stderr"
+    failed = 1
+    exit 1
+}
+
+BEGIN {
+    n = 0
+    for (s = 2; s <= 5; s++) {
+        raw[s] = 0
+        raw_in[s] = 0
+        route_in[s] = 0
+        frames[s] = 0
+    }
+}
+
+/^[ \t]*(#|$)/ { next }
+
+{
+    sub(/[ \t]*#.*/, "")
+    if (NF != 5)
+        fail("expected 5 columns (from to offset value mode), got " NF)
+    from = $1 + 0
+    to = $2 + 0
+    mode = $5
+    if (from < 2 || from > 5 || to < 2 || to > 5)
+        fail("ports must be 2..5")
+    if (from == to)
+        fail("a port cannot route to itself")
+    if (($3 == "-") != ($4 == "-"))
+        fail("offset and value are both '-' (every frame) or both set")
+    if ($3 == "-") {
+        off = 255
+        val = 0
+    } else {
+        off = $3 + 0
+        val = hex2dec($4)
+        if (off > 254)
+            fail("offset must be 0..254")
+        if (val > 255)
+            fail("value must be one byte")
+    }
+
+    if (mode == "raw") {
+        if (off != 255)
+            fail("raw routes forward every byte: offset and value must be '-'")
+        if (raw[from] || frames[from])
+            fail("a raw route must be the only route of UART" from)
+        raw[from] = to
+        raw_in[to] = 1
+        route_in[to] = 1
+    } else if (mode == "frame") {
+        if (raw[from])
+            fail("UART" from " already has a raw route")
+        r_from[n] = from
+        r_to[n] = to
+        r_off[n] = off
+        r_val[n] = val
+        frames[from]++
+        route_in[to] = 1
+        n++
+    } else
+        fail("mode must be 'frame' or 'raw'")
+}
+
+END {
+    if (failed)
+        exit 1
+
+    print "/* -----------------------------------------------------------------------------"
+    print " *  Project : DWIN-T5L-SDCC-Template"
+    print " *  File    : route_table.h (generated)"
+    print " *  Description : Generated by tools/route_gen.awk from " FILENAME "."
+    print " *                Do not edit; change the route list and rebuild."
+    print " * ----------------------------------------------------------------------------- */"
+    print "#ifndef __ROUTE_TABLE_H__"
+    print "#define __ROUTE_TABLE_H__"
+    print ""
+    print "#include \"t5l1.h\""
+    print ""
+    print "#define ROUTE_ANY 0xFF // Route_Off[] of a route that takes every frame"
+    print "#define ROUTE_COUNT " n
+    for (s = 2; s <= 5; s++)
+        print "#define ROUTE_FRAMES" s " " frames[s] " // frame routes from UART" s
+    for (s = 2; s <= 5; s++)
+        print "#define ROUTE_RAW" s " " raw[s] " // raw bridge target of UART" s ", 0 = none"
+    for (s = 2; s <= 5; s++)
+        print "#define ROUTE_IN" s " " route_in[s] " // UART" s " sends routed frames or bytes"
+    for (s = 2; s <= 5; s++)
+        print "#define ROUTE_RAW_IN" s " " raw_in[s] " // UART" s " carries a raw bridge"
+    if (n) {
+        print ""
+        print "extern __code const u8 Route_From[ROUTE_COUNT];"
+        print "extern __code const u8 Route_To[ROUTE_COUNT];"
+        print "extern __code const u8 Route_Off[ROUTE_COUNT];"
+        print "extern __code const u8 Route_Val[ROUTE_COUNT];"
+    }
+    print ""
+    print "#endif /* __ROUTE_TABLE_H__ */"
+
+    if (!n)
+        exit 0
+    print ""
+    print "#if defined(ROUTE_DEFINE) && !defined(__ROUTE_STORAGE__)"
+    print "#define __ROUTE_STORAGE__"
+    printf("__code const u8 Route_From[ROUTE_COUNT] = {")
+    for (i = 0; i < n; i++)
+        printf("%s%d", (i ? ", " : ""), r_from[i])
+    print "};"
+    printf("__code const u8 Route_To[ROUTE_COUNT] = {")
+    for (i = 0; i < n; i++)
+        printf("%s%d", (i ? ", " : ""), r_to[i])
+    print "};"
+    printf("__code const u8 Route_Off[ROUTE_COUNT] = {")
+    for (i = 0; i < n; i++)
+        printf("%s%s", (i ? ", " : ""), (r_off[i] == 255 ? "ROUTE_ANY" : r_off[i]))
+    print "};"
+    printf("__code const u8 Route_Val[ROUTE_COUNT] = {")
+    for (i = 0; i < n; i++)
+        printf("%s0x%02X", (i ? ", " : ""), r_val[i])
+    print "};"
+    print "#endif"
+}
@@ -0,0 +1,193 @@
+# ------------------------------------------------------------------------------
+#  Project : DWIN-T5L-SDCC-Template
+#  File    : vp_init_gen.awk
+#  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+#  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+#  Contact : recepsenbas@gmail.com
+#  Description : Build-time generator for the boot VP init table.
+#                Reads src/app/vp_init.txt and prints vp_init_table.h: the
+#                rows sorted by VP and merged into contiguous runs, one
+#                __code word image, per-run offsets into it and into the NOR
+#                copy, and a stamp that changes with any address or value.
+#                POSIX awk only (no asort/strtonum) so it runs under MSYS2 too.
+#
+#  Usage : awk -f tools/vp_init_gen.awk src/app/vp_init.txt > vp_init_table.h
+# ------------------------------------------------------------------------------
+
+function hex2dec(h, i, d, v)
+{
+    h = toupper(h)
+    if (substr(h, 1, 2) != "0X")
+        return h + 0
+    h = substr(h, 3)
+    v = 0
+    for (i = 1; i <= length(h); i++) {
+        d = index("0123456789ABCDEF", substr(h, i, 1)) - 1
+        if (d < 0)
+            fail("bad hex number '" h "'")
+        v = v * 16 + d
+    }
+    return v
+}
+
+function hex4(v)
+{
+    return sprintf("0x%04X", v)
+}
+
+function fail(msg)
+{
+    printf("%s:%d: %s\n", FILENAME, FNR, msg) > "/dev/stderr"
+    failed = 1
+    exit 1
+}
+
+# Fletcher-16 style sums over every address, length and value (no xor in POSIX awk)
+function stamp_add(v)
+{
+    s1 = (s1 + v) % 65521
+    s2 = (s2 + s1) % 65521
+}
+
+BEGIN {
+    nrow = 0
+    nword = 0
+}
+
+/^[ \t]*(#|$)/ { next }
+
+{
+    sub(/[ \t]*#.*/, "")
+    if (NF < 2)
+        fail("expected a VP followed by at least one value")
+    first = hex2dec($1)
+    if (first > 65535)
+        fail("VP out of range")
+
+    # values: word or word*count
+    base = nword
+    for (f = 2; f <= NF; f++) {
+        n = 1
+        v = $f
+        if (index(v, "*")) {
+            n = substr(v, index(v, "*") + 1) + 0
+            v = substr(v, 1, index(v, "*") - 1)
+            if (n < 1)
+                fail("bad repeat count in '" $f "'")
+        }
+        v = hex2dec(v)
+        if (v > 65535)
+            fail("value " $f " does not fit in 16 bits")
+        for (k = 0; k < n; k++)
+            word[nword++] = v
+    }
+    len = nword - base
+    if (first + len > 65536)
+        fail("row runs past VP 0xFFFF")
+
+    # Insertion sort by first VP (lists are small, stays POSIX)
+    for (i = nrow; i > 0 && row_first[i - 1] > first; i--) {
+        row_first[i] = row_first[i - 1]
+        row_len[i] = row_len[i - 1]
+        row_base[i] = row_base[i - 1]
+    }
+    row_first[i] = first
+    row_len[i] = len
+    row_base[i] = base
+    nrow++
+}
+
+END {
+    if (failed)
+        exit 1
+
+    # Merge touching rows into runs; a run is one burst / one NOR transfer
+    nrun = 0
+    total = 0
+    for (i = 0; i < nrow; i++) {
+        if (i && row_first[i] < row_first[i - 1] + row_len[i - 1]) {
+            printf("vp_init_gen: rows at %s and %s overlap\n",
+                   hex4(row_first[i - 1]), hex4(row_first[i])) > "/dev/stderr"
+            exit 1
+        }
+        if (!nrun || row_first[i] != run_first[nrun - 1] + run_len[nrun - 1]) {
+            run_first[nrun] = row_first[i]
+            run_len[nrun] = 0
+            run_off[nrun] = total
+            nrun++
+        }
+        for (k = 0; k < row_len[i]; k++)
+            image[total++] = word[row_base[i] + k]
+        run_len[nrun - 1] += row_len[i]
+    }
+
+    # NOR copy: stamp (2 words) first, each run padded to an even word count
+    nor = 2
+    for (r = 0; r < nrun; r++) {
+        run_nor[r] = nor
+        nor += run_len[r] + (run_len[r] % 2)
+    }
+
+    s1 = 1
+    s2 = 0
+    for (r = 0; r < nrun; r++) {
+        stamp_add(run_first[r])
+        stamp_add(run_len[r])
+        for (k = 0; k < run_len[r]; k++)
+            stamp_add(image[run_off[r] + k])
+    }
+
+    print "/* -----------------------------------------------------------------------------"
+    print " *  Project : DWIN-T5L-SDCC-Template"
+    print " *  File    : vp_init_table.h (generated)"
+    print " *  Description : Generated by tools/vp_init_gen.awk from " FILENAME "."
+    print " *                Do not edit; change the init list and rebuild."
+    print " * ----------------------------------------------------------------------------- */"
+    print "#ifndef __VP_INIT_TABLE_H__"
+    print "#define __VP_INIT_TABLE_H__"
+    print ""
+    print "#include \"t5l1.h\""
+    print ""
+    print "/* " nrow " row(s) merged into " nrun " run(s), " total " word(s) */"
+    print "#define VP_INIT_RUNS " nrun
+    print "#define VP_INIT_WORDS " total
+    print "#define VP_INIT_NOR_WORDS " nor " // stamp + padded runs"
+    printf("#define VP_INIT_STAMP 0x%04X%04XUL\n", s2, s1)
+    if (nrun) {
+        print ""
+        print "extern __code const u16 VP_Init_First[VP_INIT_RUNS];"
+        print "extern __code const u16 VP_Init_Len[VP_INIT_RUNS];"
+        print "extern __code const u16 VP_Init_Off[VP_INIT_RUNS];"
+        print "extern __code const u16 VP_Init_Nor[VP_INIT_RUNS];"
+        print "extern __code const u16 VP_Init_Data[VP_INIT_WORDS];"
+    }
+    print ""
+    print "#endif /* __VP_INIT_TABLE_H__ */"
+
+    if (!nrun)
+        exit 0
+    print ""
+    print "#if defined(VP_INIT_DEFINE) && !defined(__VP_INIT_STORAGE__)"
+    print "#define __VP_INIT_STORAGE__"
+    printf("__code const u16 VP_Init_First[VP_INIT_RUNS] = {")
+    for (r = 0; r < nrun; r++)
+        printf("%s%s", (r ? ", " : ""), hex4(run_first[r]))
+    print "};"
+    printf("__code const u16 VP_Init_Len[VP_INIT_RUNS] = {")
+    for (r = 0; r < nrun; r++)
+        printf("%s%d", (r ? ", " : ""), run_len[r])
+    print "};"
+    printf("__code const u16 VP_Init_Off[VP_INIT_RUNS] = {")
+    for (r = 0; r < nrun; r++)
+        printf("%s%d", (r ? ", " : ""), run_off[r])
+    print "};"
+    printf("__code const u16 VP_Init_Nor[VP_INIT_RUNS] = {")
+    for (r = 0; r < nrun; r++)
+        printf("%s%d", (r ? ", " : ""), run_nor[r])
+    print "};"
+    printf("__code const u16 VP_Init_Data[VP_INIT_WORDS] = {")
+    for (i = 0; i < total; i++)
+        printf("%s%s%s", (i ? "," : ""), (i % 8 ? " " : "\n    "), hex4(image[i]))
+    print "\n};"
+    print "#endif"
+}
@@ -0,0 +1,198 @@
+# ------------------------------------------------------------------------------
+#  Project : DWIN-T5L-SDCC-Template
+#  File    : watch_gen.awk
+#  Author  : Recep Şenbaş (https://github.com/recepsenbas)
+#  License : CC BY-NC-SA 4.0 (https://creativecommons.org/licenses/by-nc-sa/4.0/)
+#  Contact : recepsenbas@gmail.com
+#  Description : Build-time generator for the VP / UART watch tables.
+#                Reads src/app/watch_list.txt and prints watch_table.h with
+#                per-source range tables sorted by first VP (binary search at
+#                run time), flag enums, accessor macros and event handler
+#                prototypes.
+#                POSIX awk only (no asort/strtonum) so it runs under MSYS2 too.
+#
+#  Usage : awk -f tools/watch_gen.awk src/app/watch_list.txt > watch_table.h
+# ------------------------------------------------------------------------------
+
+function hex2dec(h, i, d, v)
+{
+    h = toupper(h)
+    if (substr(h, 1, 2) != "0X")
+        return h + 0
+    h = substr(h, 3)
+    v = 0
+    for (i = 1; i <= length(h); i++) {
+        d = index("0123456789ABCDEF", substr(h, i, 1)) - 1
+        if (d < 0)
+            fail("bad hex number '" h "'")
+        v = v * 16 + d
+    }
+    return v
+}
+
+function hex4(v)
+{
+    return sprintf("0x%04X", v)
+}
+
+function fail(msg)
+{
+    printf("%s:%d: %s\n", FILENAME, FNR, msg) > "/dev/stderr"
+    failed = 1
+    exit 1
+}
+
+BEGIN {
+    nsrc = 2
+    src_key[1] = "vp";   src_pfx[1] = "VP";   src_tbl[1] = "VP";   src_state[1] = "VP_Flag_States"
+    src_key[2] = "uart"; src_pfx[2] = "UART"; src_tbl[2] = "Uart"; src_state[2] = "Uart_Flag_States"
+    for (s = 1; s <= nsrc; s++) {
+        src_idx[src_key[s]] = s
+        nent[s] = 0
+        nflag[s] = 0
+    }
+    nhandler = 0
+}
+
+/^[ \t]*(#|$)/ { next }
+
+{
+    if (NF != 6)
+        fail("expected 6 columns (src first last id accessor handler), got " NF)
+    if (!($1 in src_idx))
+        fail("unknown source '" $1 "' (use vp or uart)")
+    s = src_idx[$1]
+
+    first = hex2dec($2)
+    last = ($3 == "-") ? first : hex2dec($3)
+    if (first > 65535 || last > 65535)
+        fail("VP out of range")
+    if (last < first)
+        fail("range end " $3 " is below start " $2)
+
+    # Flag index: first appearance of an id allocates the next slot
+    key = s SUBSEP $4
+    if (!(key in flag_of)) {
+        flag_of[key] = nflag[s]
+        flag_name[s, nflag[s]] = $4
+        flag_acc[s, nflag[s]] = $5
+        nflag[s]++
+    } else if ($5 != "-" && flag_acc[s, flag_of[key]] != "-" && flag_acc[s, flag_of[key]] != $5) {
+        fail("id " $4 " already has accessor " flag_acc[s, flag_of[key]])
+    } else if ($5 != "-") {
+        flag_acc[s, flag_of[key]] = $5
+    }
+
+    # Insertion sort by first VP (lists are small, stays POSIX)
+    n = nent[s]
+    for (i = n; i > 0 && ent_first[s, i - 1] > first; i--) {
+        ent_first[s, i] = ent_first[s, i - 1]
+        ent_last[s, i] = ent_last[s, i - 1]
+        ent_flag[s, i] = ent_flag[s, i - 1]
+        ent_hdl[s, i] = ent_hdl[s, i - 1]
+    }
+    ent_first[s, i] = first
+    ent_last[s, i] = last
+    ent_flag[s, i] = flag_of[key]
+    ent_hdl[s, i] = $6
+    nent[s] = n + 1
+
+    if ($6 != "-" && !($6 in handler_seen)) {
+        handler_seen[$6] = 1
+        handler_list[nhandler++] = $6
+    }
+}
+
+END {
+    if (failed)
+        exit 1
+
+    for (s = 1; s <= nsrc; s++)
+        for (i = 1; i < nent[s]; i++)
+            if (ent_first[s, i] <= ent_last[s, i - 1]) {
+                printf("watch_gen: %s ranges %s..%s and %s..%s overlap\n", src_key[s],
+                       hex4(ent_first[s, i - 1]), hex4(ent_last[s, i - 1]),
+                       hex4(ent_first[s, i]), hex4(ent_last[s, i])) > "/dev/stderr"
+                exit 1
+            }
+
+    print "/* -----------------------------------------------------------------------------"
+    print " *  Project : DWIN-T5L-SDCC-Template"
+    print " *  File    : watch_table.h (generated)"
+    print " *  Description : Generated by tools/watch_gen.awk from " FILENAME "."
+    print " *                Do not edit; change the watch list and rebuild."
+    print " * ----------------------------------------------------------------------------- */"
+    print "#ifndef __WATCH_TABLE_H__"
+    print "#define __WATCH_TABLE_H__"
+    print ""
+    print "#include \"t5l1.h\""
+    print "#include \"event.h\""
+    print ""
+    print "/* Handler called by Event_Dispatch() for each event in its range */"
+    print "typedef void (*watch_handler_t)(const evt_t *ev);"
+    if (nhandler) {
+        print ""
+        for (h = 0; h < nhandler; h++)
+            print "void " handler_list[h] "(const evt_t *ev);"
+    }
+
+    for (s = 1; s <= nsrc; s++) {
+        P = src_pfx[s]
+        T = src_tbl[s]
+        print ""
+        print "/* ---- " src_key[s] " watch list: " nent[s] " range(s), " nflag[s] " flag(s) ---- */"
+        print "#define " P "_FLAGS_COUNT " nflag[s]
+        print "#define " P "_WATCH_COUNT " nent[s]
+        if (nflag[s]) {
+            print ""
+            print "enum"
+            print "{"
+            for (f = 0; f < nflag[s]; f++)
+                print "    " flag_name[s, f] " = " f (f + 1 < nflag[s] ? "," : "")
+            print "};"
+            print ""
+            for (f = 0; f < nflag[s]; f++)
+                if (flag_acc[s, f] != "-")
+                    print "#define " flag_acc[s, f] " (" src_state[s] "[" flag_name[s, f] "])"
+        }
+        if (!nent[s])
+            continue
+        print ""
+        printf("extern __code const u16 %s_Watch_First[%s_WATCH_COUNT];\n", T, P)
+        printf("extern __code const u16 %s_Watch_Last[%s_WATCH_COUNT];\n", T, P)
+        printf("extern __code const u16 %s_Watch_Flag[%s_WATCH_COUNT];\n", T, P)
+        printf("extern __code const watch_handler_t %s_Watch_Handler[%s_WATCH_COUNT];\n", T, P)
+    }
+
+    print ""
+    print "#endif /* __WATCH_TABLE_H__ */"
+
+    # Storage: emitted by the one TU that defines <P>_FLAGS_DEFINE. Guarded per
+    # source because uart.c pulls in vp_flags.h and uart_flags.h back to back.
+    for (s = 1; s <= nsrc; s++) {
+        P = src_pfx[s]
+        T = src_tbl[s]
+        if (!nent[s])
+            continue
+        print ""
+        print "#if defined(" P "_FLAGS_DEFINE) && !defined(__" P "_WATCH_STORAGE__)"
+        print "#define __" P "_WATCH_STORAGE__"
+        printf("__code const u16 %s_Watch_First[%s_WATCH_COUNT] = {", T, P)
+        for (i = 0; i < nent[s]; i++)
+            printf("%s%s", (i ? ", " : ""), hex4(ent_first[s, i]))
+        print "};"
+        printf("__code const u16 %s_Watch_Last[%s_WATCH_COUNT] = {", T, P)
+        for (i = 0; i < nent[s]; i++)
+            printf("%s%s", (i ? ", " : ""), hex4(ent_last[s, i]))
+        print "};"
+        printf("__code const u16 %s_Watch_Flag[%s_WATCH_COUNT] = {", T, P)
+        for (i = 0; i < nent[s]; i++)
+            printf("%s%s", (i ? ", " : ""), flag_name[s, ent_flag[s, i]])
+        print "};"
+        printf("__code const watch_handler_t %s_Watch_Handler[%s_WATCH_COUNT] = {", T, P)
+        for (i = 0; i < nent[s]; i++)
+            printf("%s%s", (i ? ", " : ""), (ent_hdl[s, i] == "-" ? "0" : ent_hdl[s, i]))
+        print "};"
+        print "#endif"
+    }
+}